@@ -0,0 +1,35 @@
+#!/bin/bash
+
+print_message() {
+  local message="$*"
+  local len=${#message}
+
+  local border
+  border=$(printf '%*s' $((len + 6)) "" | tr ' ' '#')
+
+  echo "$border"
+  echo "# $message   #"
+  echo "$border"
+}
+
+## Build olc_tree (in a separate build directory, so the in-source build of the tutorial keeps its build type)
+print_message "Building coro-tree"
+cmake -S . -B build-benchmark -DCMAKE_BUILD_TYPE=Release
+cmake --build build-benchmark -j4 --target olc_coro_tree_benchmark
+
+## Run the suite and compare to the baseline (if any)
+mkdir -p benchmark-result
+result="benchmark-result/$(date +%Y-%m-%d-%H%M%S).csv"
+echo ""
+if [ -f benchmark-baseline.csv ]; then
+  print_message "Executing benchmark suite, comparing to benchmark-baseline.csv"
+  ./build-benchmark/bin/olc_coro_tree_benchmark "$result" --baseline benchmark-baseline.csv "$@"
+else
+  print_message "Executing benchmark suite (no benchmark-baseline.csv found)"
+  ./build-benchmark/bin/olc_coro_tree_benchmark "$result" "$@"
+fi
+status=$?
+
+echo ""
+echo "Results written to $result."
+exit $status
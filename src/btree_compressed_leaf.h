@@ -0,0 +1,315 @@
+#pragma once
+
+#include "btree_olc.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/**
+ * Leaf layout that stores the keys frame-of-reference encoded: One base key per leaf and the
+ * difference of every key to the base as 8, 16, 32, or 64bit delta. The width is chosen whenever
+ * the leaf is (re-)encoded: When it is created by a split, and when a key outside the current range
+ * is inserted, which decodes all entries and encodes them again with a new base and wider deltas.
+ * Dense integer keys (as produced by the NumericWorkloadSet) need one byte per key, which fits more
+ * entries into a leaf.
+ *
+ * Use as BTree<Key, Value, PageSize, BTreeCompressedLeaf>.
+ */
+template<class Key, class Payload, std::size_t PageSize>
+struct alignas(PageSize) BTreeCompressedLeaf : public BTreeLeafBase {
+    static_assert(std::is_integral_v<Key> && std::is_unsigned_v<Key>, "Compressed leaves need unsigned integer keys.");
+    static_assert(alignof(Payload) <= sizeof(std::uint64_t));
+
+    /// Bytes for deltas and payloads (behind the node header, high key, base key, and width).
+    static constexpr std::size_t dataSize = PageSize - sizeof(NodeBase) - 2U * sizeof(Key) - sizeof(std::uint64_t);
+
+    /**
+     * @return Offset of the payloads behind the given number of deltas of the given width.
+     */
+    static constexpr std::size_t payloadsOffset(const std::size_t width, const std::size_t entries) {
+        return (entries * width + alignof(Payload) - 1U) & ~(alignof(Payload) - 1U);
+    }
+
+    /**
+     * @return Number of entries fitting into the leaf with deltas of the given width.
+     */
+    static constexpr std::uint16_t capacity(const std::size_t width) {
+        auto entries = dataSize / (width + sizeof(Payload));
+        while (payloadsOffset(width, entries) + entries * sizeof(Payload) > dataSize) {
+            --entries;
+        }
+        return std::uint16_t(entries);
+    }
+
+    static const LeafLayoutType layoutMarker = LeafLayoutType::Compressed;
+    static const std::uint64_t maxEntries = capacity(sizeof(std::uint8_t));
+
+    /// Keys of the leaf are at most the high key (if the leaf has a right sibling).
+    Key highKey{};
+
+    Key base{0U};
+    std::uint8_t width{sizeof(std::uint8_t)};
+    alignas(std::uint64_t) std::uint8_t data[dataSize];
+
+    BTreeCompressedLeaf() { type = typeMarker; }
+
+    bool isFull() { return count == capacity(width); };
+
+    /// Entries the leaf holds at most with deltas of its current width.
+    [[nodiscard]] std::uint64_t entryCapacity() const { return capacity(width); }
+
+    /**
+     * @return True, if the key can be inserted without splitting the leaf (which may need wider deltas).
+     */
+    bool canInsert(const Key key) {
+        if (count == 0U) {
+            return true;
+        }
+        const auto lowest = std::min(base, key);
+        const auto highest = std::max(highestKey(), key);
+        return count < capacity(std::max<std::size_t>(width, requiredWidth(highest - lowest)));
+    }
+
+    /**
+     * Looks up the key; readers validate the version of the leaf afterwards. Since the leaf
+     * may be re-encoded concurrently, the number of entries is bounded by the capacity.
+     * @return True, if the key was found.
+     */
+    bool find(const Key key, Payload &payload) {
+        const auto leaf_base = base;
+        if (key < leaf_base) {
+            return false;
+        }
+        const auto delta = key - leaf_base;
+        return withWidth(width, [&](auto type) {
+            using T = decltype(type);
+            if (delta > std::numeric_limits<T>::max()) {
+                return false;
+            }
+            const auto entries = std::min(count, capacity(sizeof(T)));
+            const auto *leaf_deltas = deltas<T>();
+            const auto pos = lowerBound<T>(leaf_deltas, entries, T(delta));
+            if ((pos < entries) && (leaf_deltas[pos] == T(delta))) {
+                payload = payloads<T>()[pos];
+                return true;
+            }
+            return false;
+        });
+    }
+
+    /**
+     * Visits the entries with keys not smaller than the given key, in key order, until the visitor returns false.
+     * Readers validate the version of the leaf afterwards.
+     */
+    template<typename F>
+    void scanFrom(const Key key, F &&visit) {
+        const auto leaf_base = base;
+        withWidth(width, [&](auto type) {
+            using T = decltype(type);
+            const auto entries = std::min(count, capacity(sizeof(T)));
+            const auto *leaf_deltas = deltas<T>();
+            const auto *leaf_payloads = payloads<T>();
+            auto pos = std::uint16_t{0U};
+            if (key > leaf_base) {
+                if (key - leaf_base > std::numeric_limits<T>::max()) {
+                    return;
+                }
+                pos = lowerBound<T>(leaf_deltas, entries, T(key - leaf_base));
+            }
+            for (; pos < entries; ++pos) {
+                if (!visit(Key(leaf_base + leaf_deltas[pos]), leaf_payloads[pos])) {
+                    return;
+                }
+            }
+        });
+    }
+
+    /**
+     * Inserts or updates the key.
+     * @return True, if the key was inserted; false, if an existing key was updated.
+     */
+    bool insert(const Key key, const Payload payload) {
+        if (count > 0U && key >= base && key - base <= maxDelta(width)) {
+            return withWidth(width, [&](auto type) {
+                using T = decltype(type);
+                auto *leaf_deltas = deltas<T>();
+                auto *leaf_payloads = payloads<T>();
+                const auto delta = T(key - base);
+                const auto pos = lowerBound<T>(leaf_deltas, count, delta);
+                if ((pos < count) && (leaf_deltas[pos] == delta)) {
+                    // Upsert
+                    leaf_payloads[pos] = payload;
+                    return false;
+                }
+                assert(count < capacity(sizeof(T)));
+                countInsert(pos == count);
+                std::memmove(leaf_deltas + pos + 1, leaf_deltas + pos, sizeof(T) * (count - pos));
+                std::memmove(leaf_payloads + pos + 1, leaf_payloads + pos, sizeof(Payload) * (count - pos));
+                leaf_deltas[pos] = delta;
+                leaf_payloads[pos] = payload;
+                ++count;
+                return true;
+            });
+        }
+
+        /// The key is outside the range of the current encoding: Decode, insert, and encode with a new base/width.
+        Key keys[maxEntries + 1U];
+        Payload leaf_payloads[maxEntries + 1U];
+        const auto entries = decode(keys, leaf_payloads);
+        const auto pos = std::uint16_t(std::lower_bound(keys, keys + entries, key) - keys);
+        countInsert(pos == entries);
+        std::memmove(keys + pos + 1, keys + pos, sizeof(Key) * (entries - pos));
+        std::memmove(leaf_payloads + pos + 1, leaf_payloads + pos, sizeof(Payload) * (entries - pos));
+        keys[pos] = key;
+        leaf_payloads[pos] = payload;
+        encode(keys, leaf_payloads, entries + 1U);
+        return true;
+    }
+
+    /**
+     * Removes the key; leaves are not merged when they underflow.
+     * @return True, if the key was found.
+     */
+    bool remove(const Key key) {
+        if (count == 0U || key < base || key - base > maxDelta(width)) {
+            return false;
+        }
+        return withWidth(width, [&](auto type) {
+            using T = decltype(type);
+            auto *leaf_deltas = deltas<T>();
+            auto *leaf_payloads = payloads<T>();
+            const auto delta = T(key - base);
+            const auto pos = lowerBound<T>(leaf_deltas, count, delta);
+            if ((pos == count) || (leaf_deltas[pos] != delta)) {
+                return false;
+            }
+            std::memmove(leaf_deltas + pos, leaf_deltas + pos + 1, sizeof(T) * (count - pos - 1));
+            std::memmove(leaf_payloads + pos, leaf_payloads + pos + 1, sizeof(Payload) * (count - pos - 1));
+            --count;
+            return true;
+        });
+    }
+
+    /**
+     * Splits the leaf in the middle (or near the end, if isAppend); both parts choose base and width for their own key range.
+     */
+    BTreeCompressedLeaf *split(Key &sep, NodeAllocator &allocator, const bool isAppend = false) {
+        void *align_ptr = allocator.allocate(sizeof(BTreeCompressedLeaf), PageSize);
+        auto *new_leaf = new(align_ptr) BTreeCompressedLeaf();
+
+        Key keys[maxEntries];
+        Payload leaf_payloads[maxEntries];
+        const auto entries = decode(keys, leaf_payloads);
+        const auto left_entries = std::uint16_t(entries - splitCount(entries, isAppend));
+        appends = 0U;
+
+        new_leaf->encode(keys + left_entries, leaf_payloads + left_entries, entries - left_entries);
+        encode(keys, leaf_payloads, left_entries);
+        sep = keys[left_entries - 1U];
+        linkSplit(this, new_leaf, sep);
+        return new_leaf;
+    }
+
+    /**
+     * Adds the entries of the leaf (behind the node header) to the description for the memory access analyzer.
+     */
+    static void describe(perf::analyzer::DataType &data_type) {
+        data_type.add("high_key", sizeof(Key));
+        data_type.add("base", sizeof(Key));
+        data_type.add("width", 1U);
+        data_type.add("--padding--", sizeof(std::uint64_t) - 1U);
+        data_type.add("deltas+payloads", dataSize);
+    }
+
+private:
+    /**
+     * Calls the function with a value of the unsigned integer type that has the given width.
+     */
+    template<typename F>
+    static decltype(auto) withWidth(const std::uint8_t width, F &&function) {
+        switch (width) {
+            case sizeof(std::uint8_t):
+                return function(std::uint8_t{});
+            case sizeof(std::uint16_t):
+                return function(std::uint16_t{});
+            case sizeof(std::uint32_t):
+                return function(std::uint32_t{});
+            default:
+                return function(std::uint64_t{});
+        }
+    }
+
+    /**
+     * Branch-free lower bound: Counts the deltas smaller than the searched one.
+     * The loop has no early exit and is vectorized by the compiler.
+     */
+    template<typename T>
+    static std::uint16_t lowerBound(const T *leaf_deltas, const std::uint16_t entries, const T delta) {
+        auto pos = std::uint16_t{0U};
+        for (auto i = 0U; i < entries; ++i) {
+            pos += std::uint16_t(leaf_deltas[i] < delta);
+        }
+        return pos;
+    }
+
+    static std::uint8_t requiredWidth(const std::uint64_t range) {
+        if (range <= std::numeric_limits<std::uint8_t>::max()) {
+            return sizeof(std::uint8_t);
+        }
+        if (range <= std::numeric_limits<std::uint16_t>::max()) {
+            return sizeof(std::uint16_t);
+        }
+        if (range <= std::numeric_limits<std::uint32_t>::max()) {
+            return sizeof(std::uint32_t);
+        }
+        return sizeof(std::uint64_t);
+    }
+
+    static std::uint64_t maxDelta(const std::uint8_t width) {
+        return width >= sizeof(std::uint64_t) ? std::numeric_limits<std::uint64_t>::max()
+                                              : (std::uint64_t(1U) << (width * 8U)) - 1U;
+    }
+
+    template<typename T>
+    T *deltas() { return reinterpret_cast<T *>(data); }
+
+    template<typename T>
+    Payload *payloads() { return reinterpret_cast<Payload *>(data + payloadsOffset(sizeof(T), capacity(sizeof(T)))); }
+
+    Key highestKey() {
+        return withWidth(width, [&](auto type) { return Key(base + deltas<decltype(type)>()[count - 1U]); });
+    }
+
+    /**
+     * Writes all keys and payloads of the leaf into the given arrays.
+     * @return Number of entries.
+     */
+    std::uint16_t decode(Key *keys, Payload *leaf_payloads) {
+        withWidth(width, [&](auto type) {
+            using T = decltype(type);
+            for (auto i = 0U; i < count; ++i) {
+                keys[i] = Key(base + deltas<T>()[i]);
+            }
+            std::memcpy(leaf_payloads, payloads<T>(), sizeof(Payload) * count);
+        });
+        return count;
+    }
+
+    /**
+     * Encodes the given (sorted) keys with the smallest possible width and the first key as base.
+     */
+    void encode(const Key *keys, const Payload *leaf_payloads, const std::uint16_t entries) {
+        base = entries > 0U ? keys[0U] : Key{0U};
+        width = entries > 0U ? requiredWidth(keys[entries - 1U] - keys[0U]) : sizeof(std::uint8_t);
+        assert(entries <= capacity(width));
+        withWidth(width, [&](auto type) {
+            using T = decltype(type);
+            for (auto i = 0U; i < entries; ++i) {
+                deltas<T>()[i] = T(keys[i] - base);
+            }
+            std::memcpy(payloads<T>(), leaf_payloads, sizeof(Payload) * entries);
+        });
+        count = entries;
+    }
+};
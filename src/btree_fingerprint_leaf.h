@@ -0,0 +1,284 @@
+#pragma once
+
+#include "btree_olc.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
+
+/**
+ * Leaf layout that keeps the entries unsorted: A key is written to the first free slot (no memmove),
+ * an occupancy bitmap marks the used slots, and a one-byte fingerprint (hash) per slot is compared
+ * with a single SIMD instruction (per 16 slots) on lookup; only the slots with a matching fingerprint
+ * compare the key. The entries are sorted when the leaf is split (or scanned).
+ *
+ * Compared to BTreeLeaf, the insert critical section is shorter and lookups need no binary search;
+ * the leaf holds fewer entries (fingerprints, bitmap, and highest key take space).
+ *
+ * Use as BTree<Key, Value, PageSize, BTreeFingerprintLeaf>.
+ */
+template<class Key, class Payload, std::size_t PageSize>
+struct alignas(PageSize) BTreeFingerprintLeaf : public BTreeLeafBase {
+    static_assert(alignof(Key) <= 16U && alignof(Payload) <= 16U);
+
+    /**
+     * @return Bytes of the fingerprints of the given number of slots, padded to full vectors.
+     */
+    static constexpr std::size_t fingerprintsSize(const std::size_t entries) { return (entries + 15U) & ~std::size_t{15U}; }
+
+    /// Bytes of the node header, bitmap, high key, and highest key.
+    static constexpr std::size_t headerSize = sizeof(NodeBase) + sizeof(std::uint64_t) + 2U * sizeof(Key);
+
+    /// Offset of the fingerprints, aligned for vector loads.
+    static constexpr std::size_t fingerprintsOffset = (headerSize + 15U) & ~std::size_t{15U};
+
+    /**
+     * @return Number of entries fitting into the leaf (at most one per bit of the bitmap).
+     */
+    static constexpr std::uint64_t capacity() {
+        auto entries = std::min<std::size_t>(64U, (PageSize - fingerprintsOffset) / (1U + sizeof(Key) + sizeof(Payload)));
+        while (fingerprintsOffset + fingerprintsSize(entries) + entries * (sizeof(Key) + sizeof(Payload)) > PageSize) {
+            --entries;
+        }
+        return entries;
+    }
+
+    static const LeafLayoutType layoutMarker = LeafLayoutType::Fingerprint;
+    static const std::uint64_t maxEntries = capacity();
+
+    /// Bit i is set, if slot i holds an entry.
+    std::uint64_t bitmap{0U};
+
+    /// Keys of the leaf are at most the high key (if the leaf has a right sibling).
+    Key highKey{};
+
+    /// Highest key inserted since the last split; detects appends (see SplitPolicy).
+    Key highest{};
+
+    alignas(16) std::uint8_t fingerprints[fingerprintsSize(maxEntries)];
+    Key keys[maxEntries];
+    Payload payloads[maxEntries];
+
+    BTreeFingerprintLeaf() { type = typeMarker; }
+
+    bool isFull() { return count == maxEntries; };
+
+    /// Entries the leaf holds at most.
+    [[nodiscard]] std::uint64_t entryCapacity() const { return maxEntries; }
+
+    /**
+     * @return True, if the key can be inserted without splitting the leaf.
+     */
+    bool canInsert(Key) { return !isFull(); }
+
+    /**
+     * Looks up the key; readers validate the version of the leaf afterwards.
+     * @return True, if the key was found.
+     */
+    bool find(const Key key, Payload &payload) {
+        const auto slot = findSlot(key);
+        if (slot < maxEntries) {
+            payload = payloads[slot];
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Visits the entries with keys not smaller than the given key, in key order, until the visitor returns false.
+     * Readers validate the version of the leaf afterwards.
+     */
+    template<typename F>
+    void scanFrom(const Key key, F &&visit) {
+        /// Sort copies of the keys: The leaf may be modified concurrently.
+        Key leaf_keys[maxEntries];
+        std::uint8_t slots[maxEntries];
+        auto entries = 0U;
+        for (auto used = bitmap & validSlots(); used != 0U; used &= used - 1U) {
+            const auto slot = std::uint8_t(std::countr_zero(used));
+            if (!(keys[slot] < key)) {
+                leaf_keys[entries] = keys[slot];
+                slots[entries++] = slot;
+            }
+        }
+        sortSlots(leaf_keys, slots, entries);
+        for (auto i = 0U; i < entries; ++i) {
+            if (!visit(leaf_keys[i], payloads[slots[i]])) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Inserts or updates the key.
+     * @return True, if the key was inserted; false, if an existing key was updated.
+     */
+    bool insert(const Key key, const Payload payload) {
+        assert(count < maxEntries);
+        if (const auto slot = findSlot(key); slot < maxEntries) {
+            // Upsert
+            payloads[slot] = payload;
+            return false;
+        }
+
+        const auto is_append = count == 0U || highest < key;
+        countInsert(is_append);
+        if (is_append) {
+            highest = key;
+        }
+
+        const auto slot = std::countr_zero(~bitmap);
+        fingerprints[slot] = fingerprint(key);
+        keys[slot] = key;
+        payloads[slot] = payload;
+        bitmap |= std::uint64_t(1U) << slot;
+        ++count;
+        return true;
+    }
+
+    /**
+     * Removes the key; leaves are not merged when they underflow.
+     * @return True, if the key was found.
+     */
+    bool remove(const Key key) {
+        const auto slot = findSlot(key);
+        if (slot == maxEntries) {
+            return false;
+        }
+        bitmap &= ~(std::uint64_t(1U) << slot);
+        --count;
+        return true;
+    }
+
+    /**
+     * Sorts the entries and splits the leaf in the middle (or near the end, if isAppend); both leaves are
+     * written sorted and without gaps.
+     */
+    BTreeFingerprintLeaf *split(Key &sep, NodeAllocator &allocator, const bool isAppend = false) {
+        void *align_ptr = allocator.allocate(sizeof(BTreeFingerprintLeaf), PageSize);
+        auto *new_leaf = new(align_ptr) BTreeFingerprintLeaf();
+
+        Key leaf_keys[maxEntries];
+        std::uint8_t slots[maxEntries];
+        auto entries = 0U;
+        for (auto used = bitmap; used != 0U; used &= used - 1U) {
+            const auto slot = std::uint8_t(std::countr_zero(used));
+            leaf_keys[entries] = keys[slot];
+            slots[entries++] = slot;
+        }
+        sortSlots(leaf_keys, slots, entries);
+
+        Payload leaf_payloads[maxEntries];
+        for (auto i = 0U; i < entries; ++i) {
+            leaf_payloads[i] = payloads[slots[i]];
+        }
+
+        const auto left_entries = entries - splitCount(entries, isAppend);
+        appends = 0U;
+        new_leaf->assign(leaf_keys + left_entries, leaf_payloads + left_entries, entries - left_entries);
+        assign(leaf_keys, leaf_payloads, left_entries);
+        sep = leaf_keys[left_entries - 1U];
+        linkSplit(this, new_leaf, sep);
+        return new_leaf;
+    }
+
+    /**
+     * Adds the entries of the leaf (behind the node header) to the description for the memory access analyzer.
+     */
+    static void describe(perf::analyzer::DataType &data_type) {
+        constexpr auto used_size = fingerprintsOffset + fingerprintsSize(maxEntries) +
+                                   (sizeof(Key) + sizeof(Payload)) * maxEntries;
+        data_type.add("bitmap", sizeof(std::uint64_t));
+        data_type.add("high_key", sizeof(Key));
+        data_type.add("highest", sizeof(Key));
+        if constexpr (fingerprintsOffset > headerSize) {
+            data_type.add("--padding--", fingerprintsOffset - headerSize);
+        }
+        data_type.add("fingerprints", fingerprintsSize(maxEntries));
+        data_type.add("keys", sizeof(Key) * maxEntries);
+        data_type.add("payloads", sizeof(Payload) * maxEntries);
+        if constexpr (sizeof(BTreeFingerprintLeaf) > used_size) {
+            data_type.add("--padding--", sizeof(BTreeFingerprintLeaf) - used_size);
+        }
+    }
+
+private:
+    /**
+     * @return Mask of the slots that exist; bounds the bitmap read by optimistic readers.
+     */
+    static constexpr std::uint64_t validSlots() {
+        return maxEntries >= 64U ? ~std::uint64_t{0U} : (std::uint64_t(1U) << maxEntries) - 1U;
+    }
+
+    static std::uint8_t fingerprint(const Key key) {
+        return std::uint8_t((std::uint64_t(std::hash<Key>{}(key)) * 0x9E3779B97F4A7C15ULL) >> 56U);
+    }
+
+    /**
+     * @return Mask of the used slots whose fingerprint matches the one of the key.
+     */
+    std::uint64_t matchingSlots(const Key key) {
+        const auto key_fingerprint = fingerprint(key);
+        auto matches = std::uint64_t{0U};
+#ifdef __SSE2__
+        const auto needle = _mm_set1_epi8(char(key_fingerprint));
+        for (auto i = 0U; i < fingerprintsSize(maxEntries); i += 16U) {
+            const auto block = _mm_load_si128(reinterpret_cast<const __m128i *>(fingerprints + i));
+            matches |= std::uint64_t(std::uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)))) << i;
+        }
+#else
+        for (auto i = 0U; i < maxEntries; ++i) {
+            matches |= std::uint64_t(fingerprints[i] == key_fingerprint) << i;
+        }
+#endif
+        return matches & bitmap & validSlots();
+    }
+
+    /**
+     * @return Slot of the key, or maxEntries if the key is not in the leaf.
+     */
+    std::uint64_t findSlot(const Key key) {
+        for (auto candidates = matchingSlots(key); candidates != 0U; candidates &= candidates - 1U) {
+            const auto slot = std::uint64_t(std::countr_zero(candidates));
+            if (keys[slot] == key) {
+                return slot;
+            }
+        }
+        return maxEntries;
+    }
+
+    /**
+     * Sorts the keys (and their slots alongside) by insertion sort; leaves hold at most 64 entries.
+     */
+    static void sortSlots(Key *leaf_keys, std::uint8_t *slots, const std::uint32_t entries) {
+        for (auto i = 1U; i < entries; ++i) {
+            const auto key = leaf_keys[i];
+            const auto slot = slots[i];
+            auto j = i;
+            for (; j > 0U && key < leaf_keys[j - 1U]; --j) {
+                leaf_keys[j] = leaf_keys[j - 1U];
+                slots[j] = slots[j - 1U];
+            }
+            leaf_keys[j] = key;
+            slots[j] = slot;
+        }
+    }
+
+    /**
+     * Replaces the entries of the leaf by the given (sorted) ones, stored in the first slots.
+     */
+    void assign(const Key *leaf_keys, const Payload *leaf_payloads, const std::uint32_t entries) {
+        for (auto i = 0U; i < entries; ++i) {
+            fingerprints[i] = fingerprint(leaf_keys[i]);
+            keys[i] = leaf_keys[i];
+            payloads[i] = leaf_payloads[i];
+        }
+        bitmap = entries >= 64U ? ~std::uint64_t{0U} : (std::uint64_t(1U) << entries) - 1U;
+        highest = entries > 0U ? leaf_keys[entries - 1U] : Key{};
+        count = entries;
+    }
+};
@@ -13,11 +13,21 @@
  ***********************************************************************************************/
 
 #include <cstdint>
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
 #include <sched.h>
 #ifdef __x86_64__
 #include <immintrin.h>
@@ -25,6 +35,13 @@
 #include "prefetch.h"
 #include <perfcpp/analyzer/memory_access.h>
 #include "coroutine/coroutine.h"
+#include "memory/node_allocator.h"
+#include "memory/value_heap.h"
+#include "persistence/snapshot.h"
+#include "persistence/write_ahead_log.h"
+#include "hot_key_cache.h"
+#include "leaf_versions.h"
+#include "tree_statistics.h"
 
 
 enum class PageType : uint8_t {
@@ -32,6 +49,52 @@ enum class PageType : uint8_t {
     BTreeLeaf = 2
 };
 
+/**
+ * Layout of the leaves; stored in snapshots, which are only restored into trees of the same layout.
+ */
+enum class LeafLayoutType : uint8_t {
+    Sorted = 1,
+    Compressed = 2,
+    Fingerprint = 3
+};
+
+/**
+ * How a request waits before restarting after a conflict.
+ */
+enum class BackoffPolicy : uint8_t {
+    /// Pause for the first restarts, then yield the thread (blocks all coroutines of the thread).
+    Spin = 0,
+
+    /// Suspend the restarting coroutine to the executor, which resumes the other requests in the meantime;
+    /// the thread is yielded only after many restarts.
+    Suspend = 1
+};
+
+/**
+ * Where full nodes are split.
+ */
+enum class SplitPolicy : uint8_t {
+    /// Always split in the middle.
+    Midpoint = 0,
+
+    /// Split near the end if the node received a sequential stream of inserts (each key larger than all others),
+    /// so that monotonic keys leave full instead of half-empty nodes behind; split in the middle otherwise.
+    Adaptive = 1
+};
+
+/**
+ * How a descent makes sure that it reached the node responsible for the key.
+ */
+enum class Synchronization : uint8_t {
+    /// Validate the parent after reading the child (optimistic lock coupling); any split of a sibling restarts.
+    LockCoupling = 0,
+
+    /// B-link: Nodes hold a high key and a link to their right sibling. A descent that reaches a node split
+    /// after the parent was read moves right instead of restarting, and leaves are split without locking the
+    /// parent; the separator is posted to the parent afterward.
+    BLink = 1
+};
+
 static const uint64_t cacheLineSize = 64U;
 
 struct OptLock {
@@ -88,8 +151,53 @@ struct OptLock {
 
 struct NodeBase : public OptLock {
     PageType type;
+
+    /// Number of restarts caused by conflicting accesses to this (leaf) node since it was created; approximate.
+    std::atomic<std::uint8_t> contention{0U};
+
     std::uint16_t count{0U};
 
+    /// Distance to the leaves (0 for leaves); unlike the depth, it does not change when the root is split.
+    std::uint8_t height{0U};
+
+    /// Inserts behind the largest key of the node minus other inserts since the last split (saturating).
+    std::uint8_t appends{0U};
+
+    /// Right sibling on the same height (nullptr for the last node); keys beyond the high key of the node live there.
+    NodeBase *next{nullptr};
+
+    /**
+     * Tracks whether the node receives a sequential stream of inserts; called by nodes for every new key.
+     * Keys inserted out of order (e.g., by interleaved requests) only decrement the score.
+     *
+     * @param isAppend True, if the key was inserted behind all other keys.
+     */
+    void countInsert(const bool isAppend) {
+        appends = isAppend ? std::uint8_t(std::min(appends + 1U, 255U)) : std::uint8_t(appends > 0U ? appends - 1U : 0U);
+    }
+
+    /**
+     * Random keys are appended with a probability of 1/(count+1) and hardly accumulate a score.
+     *
+     * @return True, if the node mostly received keys behind all others since the last split.
+     */
+    [[nodiscard]] bool isSequential() const noexcept { return appends >= std::max(2U, count / 4U); }
+
+    /**
+     * @param entries Number of entries of the node that is split.
+     * @param isAppend Split near the end instead of in the middle. The old node keeps headroom for keys
+     *  that arrive late (e.g., from interleaved requests): 10% of the entries, but up to 8 entries
+     *  in small nodes, at most 25%.
+     * @return Number of entries moved to the new (right) node.
+     */
+    static std::uint16_t splitCount(const std::uint16_t entries, const bool isAppend) {
+        if (isAppend) {
+            const auto headroom = std::min<std::uint16_t>(entries / 4U, std::max<std::uint16_t>(entries / 10U, 8U));
+            return std::max<std::uint16_t>(1U, headroom);
+        }
+        return std::uint16_t(entries - entries / 2U);
+    }
+
     /**
      * Prefetches the entire node with the given size.
      * @tparam PageSize Size of the node.
@@ -98,29 +206,47 @@ struct NodeBase : public OptLock {
     void prefetch() {
         SWPrefetcher::prefetch<0U, PageSize / cacheLineSize, SWPrefetcher::Target::ALL>(this);
     }
-
-    virtual ~NodeBase() = default;
 };
 
+/**
+ * Links the node created by a split to the right of the split node: The new node takes over the
+ * right sibling and the high key of the split node, whose keys are now at most the separator.
+ */
+template<class Node, class Key>
+void linkSplit(Node *node, Node *new_node, const Key sep) {
+    new_node->next = node->next;
+    new_node->highKey = node->highKey;
+    node->next = new_node;
+    node->highKey = sep;
+}
+
 struct BTreeLeafBase : public NodeBase {
     static const PageType typeMarker = PageType::BTreeLeaf;
-
-    ~BTreeLeafBase() override = default;
 };
 
 template<class Key, class Payload, std::size_t PageSize>
 struct alignas(PageSize) BTreeLeaf : public BTreeLeafBase {
-    static const std::uint64_t maxEntries = (PageSize - sizeof(NodeBase)) / (sizeof(Key) + sizeof(Payload));
+    static const LeafLayoutType layoutMarker = LeafLayoutType::Sorted;
+    static const std::uint64_t maxEntries = (PageSize - sizeof(NodeBase) - sizeof(Key)) / (sizeof(Key) + sizeof(Payload));
+
+    /// Keys of the leaf are at most the high key (if the leaf has a right sibling).
+    Key highKey{};
 
     Key keys[maxEntries];
     Payload payloads[maxEntries];
 
     BTreeLeaf() { type = typeMarker; }
 
-    ~BTreeLeaf() override = default;
-
     bool isFull() { return count == maxEntries; };
 
+    /// Entries the leaf holds at most.
+    [[nodiscard]] std::uint64_t entryCapacity() const { return maxEntries; }
+
+    /**
+     * @return True, if the key can be inserted without splitting the leaf.
+     */
+    bool canInsert(Key) { return !isFull(); }
+
     unsigned lowerBound(Key k) {
         unsigned lower = 0;
         unsigned upper = count;
@@ -137,47 +263,118 @@ struct alignas(PageSize) BTreeLeaf : public BTreeLeafBase {
         return lower;
     }
 
-    void insert(const Key key, const Payload payload) {
+    /**
+     * Looks up the key; readers validate the version of the leaf afterwards.
+     * @return True, if the key was found.
+     */
+    bool find(const Key key, Payload &payload) {
+        const auto pos = lowerBound(key);
+        if ((pos < count) && (keys[pos] == key)) {
+            payload = payloads[pos];
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * Visits the entries with keys not smaller than the given key, in key order, until the visitor returns false.
+     * Readers validate the version of the leaf afterwards.
+     */
+    template<typename F>
+    void scanFrom(const Key key, F &&visit) {
+        const auto entries = std::min<std::uint64_t>(count, std::uint64_t{maxEntries});
+        for (auto pos = entries > 0U ? std::uint64_t(lowerBound(key)) : 0U; pos < entries; ++pos) {
+            if (!visit(keys[pos], payloads[pos])) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Inserts or updates the key.
+     * @return True, if the key was inserted; false, if an existing key was updated.
+     */
+    bool insert(const Key key, const Payload payload) {
         assert(count < maxEntries);
         if (count) {
             const auto pos = lowerBound(key);
             if ((pos < count) && (keys[pos] == key)) {
                 // Upsert
                 payloads[pos] = payload;
-                return;
+                return false;
             }
+            countInsert(pos == count);
             std::memmove(keys + pos + 1, keys + pos, sizeof(Key) * (count - pos));
             std::memmove(payloads + pos + 1, payloads + pos, sizeof(Payload) * (count - pos));
             keys[pos] = key;
             payloads[pos] = payload;
         } else {
+            countInsert(true);
             keys[0] = key;
             payloads[0] = payload;
         }
         ++count;
+        return true;
+    }
+
+    /**
+     * Removes the key; leaves are not merged when they underflow.
+     * @return True, if the key was found.
+     */
+    bool remove(const Key key) {
+        if (count == 0U) {
+            return false;
+        }
+        const auto pos = lowerBound(key);
+        if ((pos == count) || (keys[pos] != key)) {
+            return false;
+        }
+        std::memmove(keys + pos, keys + pos + 1, sizeof(Key) * (count - pos - 1));
+        std::memmove(payloads + pos, payloads + pos + 1, sizeof(Payload) * (count - pos - 1));
+        --count;
+        return true;
     }
 
-    BTreeLeaf *split(Key &sep) {
-        void *align_ptr = std::aligned_alloc(PageSize, sizeof(BTreeLeaf));
+    /**
+     * @param isAppend Split near the end instead of in the middle (see SplitPolicy).
+     */
+    BTreeLeaf *split(Key &sep, NodeAllocator &allocator, const bool isAppend = false) {
+        void *align_ptr = allocator.allocate(sizeof(BTreeLeaf), PageSize);
         auto *new_leaf = new(align_ptr) BTreeLeaf();
-        new_leaf->count = count - (count / 2);
+        new_leaf->count = splitCount(count, isAppend);
         count = count - new_leaf->count;
+        appends = 0U;
         std::memcpy(new_leaf->keys, keys + count, sizeof(Key) * new_leaf->count);
         std::memcpy(new_leaf->payloads, payloads + count, sizeof(Payload) * new_leaf->count);
         sep = keys[count - 1];
+        linkSplit(this, new_leaf, sep);
         return new_leaf;
     }
+
+    /**
+     * Adds the entries of the leaf (behind the node header) to the description for the memory access analyzer.
+     */
+    static void describe(perf::analyzer::DataType &data_type) {
+        constexpr auto used_size = sizeof(NodeBase) + sizeof(Key) + (sizeof(Key) + sizeof(Payload)) * maxEntries;
+        data_type.add("high_key", sizeof(Key));
+        data_type.add("keys", sizeof(Key) * maxEntries);
+        data_type.add("payloads", sizeof(Payload) * maxEntries);
+        if constexpr (sizeof(BTreeLeaf) > used_size) {
+            data_type.add("--padding--", sizeof(BTreeLeaf) - used_size);
+        }
+    }
 };
 
 struct BTreeInnerBase : public NodeBase {
     static const PageType typeMarker = PageType::BTreeInner;
-
-    ~BTreeInnerBase() override = default;
 };
 
 template<class Key, std::size_t PageSize>
 struct alignas(PageSize) BTreeInner : public BTreeInnerBase {
-    static const uint64_t maxEntries = (PageSize - sizeof(NodeBase)) / (sizeof(Key) + sizeof(NodeBase *));
+    static const uint64_t maxEntries = (PageSize - sizeof(NodeBase) - sizeof(Key)) / (sizeof(Key) + sizeof(NodeBase *));
+
+    /// Keys below the node are at most the high key (if the node has a right sibling).
+    Key highKey{};
 
     Key keys[maxEntries]{};
     NodeBase *children[maxEntries]{};
@@ -187,14 +384,6 @@ struct alignas(PageSize) BTreeInner : public BTreeInnerBase {
         type = typeMarker;
     }
 
-    ~BTreeInner() override {
-        for (auto i = 0u; i <= count; i++) {
-            if (children[i] != nullptr) {
-                delete children[i];
-            }
-        }
-    }
-
     bool isFull() { return count == (maxEntries - 1); };
 
     unsigned lowerBound(Key k) {
@@ -213,20 +402,27 @@ struct alignas(PageSize) BTreeInner : public BTreeInnerBase {
         return lower;
     }
 
-    BTreeInner *split(Key &sep) {
-        void *align_ptr = std::aligned_alloc(PageSize, sizeof(BTreeInner));
+    /**
+     * @param isAppend Split near the end instead of in the middle (see SplitPolicy).
+     */
+    BTreeInner *split(Key &sep, NodeAllocator &allocator, const bool isAppend = false) {
+        void *align_ptr = allocator.allocate(sizeof(BTreeInner), PageSize);
         auto *newInner = new(align_ptr) BTreeInner();
-        newInner->count = count - (count / 2);
+        newInner->height = height;
+        newInner->count = splitCount(count, isAppend);
         count = count - newInner->count - 1;
+        appends = 0U;
         sep = keys[count];
         std::memcpy(newInner->keys, keys + count + 1, sizeof(Key) * (newInner->count + 1));
         std::memcpy(newInner->children, children + count + 1, sizeof(NodeBase *) * (newInner->count + 1));
+        linkSplit(this, newInner, sep);
         return newInner;
     }
 
     void insert(const Key key, NodeBase *child) {
         assert(count < maxEntries - 1);
         const auto pos = lowerBound(key);
+        countInsert(pos == count);
         std::memmove(keys + pos + 1, keys + pos, sizeof(Key) * (count - pos + 1));
         std::memmove(children + pos + 1, children + pos, sizeof(NodeBase *) * (count - pos + 1));
         keys[pos] = key;
@@ -236,35 +432,333 @@ struct alignas(PageSize) BTreeInner : public BTreeInnerBase {
     }
 };
 
-template<class Key, class Value, std::size_t PageSize = 256U>
+/**
+ * @tparam Key Type of the keys.
+ * @tparam Value Type of the values.
+ * @tparam PageSize Size of a node.
+ * @tparam LeafLayout Layout of the leaves, e.g., BTreeLeaf or BTreeCompressedLeaf.
+ */
+template<class Key, class Value, std::size_t PageSize = 256U,
+        template<class, class, std::size_t> class LeafLayout = BTreeLeaf>
 struct BTree {
     using task_type = Coroutine;
+    using key_type = Key;
+    using value_type = Value;
+
+    /// Size (and alignment) of the nodes.
+    static constexpr std::size_t page_size = PageSize;
+
+    /// Values larger than two words are stored out-of-line in the value heap; leaves hold a handle instead.
+    static constexpr bool is_out_of_line_values = is_out_of_line_value_v<Value>;
+    using Payload = std::conditional_t<is_out_of_line_values, ValueHandle, Value>;
+    using Leaf = LeafLayout<Key, Payload, PageSize>;
 
     std::atomic<NodeBase *> root;
 
-    BTree() {
-        void *root_ptr = std::aligned_alloc(PageSize, sizeof(BTreeLeaf<Key, Value, PageSize>));
-        root = new(root_ptr) BTreeLeaf<Key, Value, PageSize>();
+    /**
+     * Memory of all nodes; nodes are released together with the tree.
+     */
+    NodeAllocator node_allocator;
+
+    /**
+     * File mapping, if the tree was restored from a snapshot.
+     */
+    SnapshotMapping snapshot;
+
+    /**
+     * Optional log of all modifications; operations are appended while the leaf is locked
+     * and committed by the executor once per round (group commit).
+     */
+    WriteAheadLog<Key, Value> *write_ahead_log{nullptr};
+
+    /**
+     * Storage of out-of-line values (only for values larger than two words).
+     */
+    [[no_unique_address]] std::conditional_t<is_out_of_line_values, ValueHeap<Value>, std::monostate> value_heap;
+
+    /**
+     * Optional cache of frequently looked up keys (only for values stored inline); the executor answers
+     * lookups of cached keys without a coroutine. Writers update or invalidate cached keys under the leaf lock.
+     */
+    HotKeyCache<Key, Value> *hot_key_cache{nullptr};
+
+    /**
+     * How requests wait before restarting after a conflict.
+     */
+    BackoffPolicy backoff_policy{BackoffPolicy::Suspend};
+
+    /**
+     * Leaves that caused this many restarts are split before they are full,
+     * spreading hot keys over more locks (0 disables contention splitting).
+     */
+    std::uint8_t contention_split_threshold{16U};
+
+    /**
+     * Where full nodes are split.
+     */
+    SplitPolicy split_policy{SplitPolicy::Adaptive};
+
+    /**
+     * How descents synchronize with splits; set before the tree is used.
+     */
+    Synchronization synchronization{Synchronization::LockCoupling};
+
+    /**
+     * Images of leaves preserved for open read views, see open_read_view().
+     */
+    LeafVersions<Leaf> leaf_versions;
+
+    /**
+     * Number of inner nodes per height, maintained by the (rare) splits of inner nodes; nodes are never freed.
+     * Leaves allocated by the tree are derived from the node allocator, which keeps leaf splits free of a
+     * shared counter; height 0 holds the leaves restored from a snapshot.
+     */
+    std::array<std::atomic<std::uint64_t>, 32U> count_nodes_per_height{};
+
+    explicit BTree(const HugePageMode huge_page_mode = HugePageMode::Transparent) : node_allocator(huge_page_mode) {
+        void *root_ptr = node_allocator.allocate(sizeof(Leaf), PageSize);
+        root = new(root_ptr) Leaf();
+    }
+
+    /**
+     * Restores the tree from a snapshot written by save_snapshot(). Instead of rebuilding the tree,
+     * the file is mapped into memory and only the child offsets of inner nodes are turned into pointers;
+     * leaves are paged in on first access. Nodes created by later splits are allocated as usual.
+     *
+     * @param snapshot_file File written by save_snapshot().
+     * @param snapshot_mode Map the nodes copy-on-write or read-only (lookups only).
+     * @param huge_page_mode Backing of nodes allocated after restoring.
+     */
+    BTree(const std::string &snapshot_file, const SnapshotMode snapshot_mode,
+          const HugePageMode huge_page_mode = HugePageMode::Transparent)
+            : node_allocator(huge_page_mode), snapshot(snapshot_file, snapshot_mode) {
+        static_assert(is_out_of_line_values == false, "Snapshots do not include the value heap.");
+        const auto &header = snapshot.header();
+        if (header.page_size != PageSize || header.key_size != sizeof(Key) || header.value_size != sizeof(Value) ||
+            header.leaf_layout != std::uint8_t(Leaf::layoutMarker)) {
+            throw std::runtime_error{"Snapshot file '" + snapshot_file + "' was written by a different tree type."};
+        }
+
+        /// Inner nodes are stored in front of all leaves; translate their child (and link) offsets into pointers.
+        for (auto i = 0ULL; i < header.count_inner_nodes; ++i) {
+            auto *inner = reinterpret_cast<BTreeInner<Key, PageSize> *>(snapshot.at(SnapshotHeader::size + i * PageSize));
+            for (auto child = 0U; child <= inner->count; ++child) {
+                inner->children[child] = reinterpret_cast<NodeBase *>(snapshot.at(std::uintptr_t(inner->children[child])));
+            }
+            if (inner->next != nullptr) {
+                inner->next = reinterpret_cast<NodeBase *>(snapshot.at(std::uintptr_t(inner->next)));
+            }
+            count_node(inner);
+        }
+        count_nodes_per_height[0U].store(header.count_leaf_nodes);
+        root = reinterpret_cast<NodeBase *>(snapshot.at(header.root_offset));
+
+        if (snapshot_mode == SnapshotMode::ReadOnly) {
+            snapshot.protect();
+        }
+    }
+
+    ~BTree() = default;
+
+    /**
+     * Writes the tree into a file in a position-independent layout: One header page, all inner nodes
+     * breadth-first, and all leaves in key order. Inner nodes store the file offset of each child (and of
+     * their right sibling) instead of the pointer. Links of leaves are not stored, so that restoring does not
+     * touch the leaves; a leaf without link is bounded by its parent, which holds the separators of all leaves
+     * once no insert is in flight. The tree must not be modified while the snapshot is written.
+     *
+     * @param snapshot_file Name of the file.
+     * @return True, if the snapshot was written.
+     */
+    bool save_snapshot(const std::string &snapshot_file) const {
+        static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>);
+        static_assert(is_out_of_line_values == false, "Snapshots do not include the value heap.");
+
+        /// Collect all nodes breadth-first; since all leaves are on the same level, they follow the inner nodes.
+        auto nodes = std::vector<NodeBase *>{root.load()};
+        auto header = SnapshotHeader{};
+        for (auto i = 0ULL; i < nodes.size(); ++i) {
+            if (nodes[i]->type == PageType::BTreeInner) {
+                ++header.count_inner_nodes;
+                auto *inner = static_cast<BTreeInner<Key, PageSize> *>(nodes[i]);
+                nodes.insert(nodes.end(), inner->children, inner->children + inner->count + 1U);
+            } else {
+                ++header.count_leaf_nodes;
+            }
+        }
+        header.page_size = PageSize;
+        header.key_size = sizeof(Key);
+        header.value_size = sizeof(Value);
+        header.leaf_layout = std::uint8_t(Leaf::layoutMarker);
+        header.root_offset = SnapshotHeader::size;
+
+        auto out_stream = std::ofstream{snapshot_file, std::ios::binary | std::ios::trunc};
+        if (out_stream.good() == false) {
+            return false;
+        }
+
+        alignas(PageSize) std::array<char, SnapshotHeader::size> header_page{};
+        std::memcpy(header_page.data(), &header, sizeof(SnapshotHeader));
+        out_stream.write(header_page.data(), header_page.size());
+
+        /// Children are numbered in the same (breadth-first) order the nodes were collected.
+        auto next_child_index = 1ULL;
+        alignas(PageSize) std::array<char, PageSize> page{};
+        for (auto i = 0ULL; i < nodes.size(); ++i) {
+            auto *node = nodes[i];
+            std::memcpy(page.data(), static_cast<void *>(node), PageSize);
+            auto *node_on_disk = reinterpret_cast<NodeBase *>(page.data());
+            node_on_disk->type_version_lock_obsolete.store(0b100);
+            node_on_disk->contention.store(0U);
+            node_on_disk->appends = 0U;
+            node_on_disk->next = nullptr;
+
+            if (node->type == PageType::BTreeInner) {
+                auto *inner_on_disk = reinterpret_cast<BTreeInner<Key, PageSize> *>(page.data());
+                for (auto child = 0U; child <= inner_on_disk->count; ++child) {
+                    const auto offset = SnapshotHeader::size + next_child_index++ * PageSize;
+                    inner_on_disk->children[child] = reinterpret_cast<NodeBase *>(offset);
+                }
+
+                /// The right sibling is the next node of the same height in breadth-first order.
+                if (node->next != nullptr) {
+                    assert(node->next == nodes[i + 1U] && "A separator was not posted yet.");
+                    inner_on_disk->next = reinterpret_cast<NodeBase *>(SnapshotHeader::size + (i + 1U) * PageSize);
+                }
+            }
+            out_stream.write(page.data(), page.size());
+        }
+
+        return out_stream.good();
+    }
+
+    /**
+     * Inserts or updates the key. Out-of-line values are written to the value heap before
+     * descending, so that neither the (large) value is copied into the coroutine frame
+     * nor written while holding the leaf lock.
+     */
+    Coroutine insert(const Key key, const Value &value) {
+        if constexpr (is_out_of_line_values) {
+            return insert_payload(key, value_heap.allocate(value));
+        } else {
+            return insert_payload(key, value);
+        }
+    }
+
+    /**
+     * Function of modify_payload() that overwrites the payload: Inserts skip reading the current payload.
+     */
+    struct Assign {
+        Payload payload;
+    };
+
+    /**
+     * Inserts the key unless it exists; a single descent, the check and the insert are atomic.
+     *
+     * @param key Key.
+     * @param value Value inserted if the key is missing (written to the value heap in any case, if out-of-line).
+     * @param result The value of the key afterward: The existing one, or the inserted one.
+     */
+    Coroutine insert_if_absent(const Key key, const Value &value, Value &result) {
+        if constexpr (is_out_of_line_values) {
+            return modify_payload(key, [handle = value_heap.allocate(value), &result, this](const bool is_found,
+                                                                                          Payload &payload) {
+                if (is_found == false) {
+                    payload = handle;
+                }
+                result = *value_heap.get(payload);
+                return is_found == false;
+            });
+        } else {
+            return modify_payload(key, [value, &result](const bool is_found, Payload &payload) {
+                if (is_found == false) {
+                    payload = value;
+                }
+                result = payload;
+                return is_found == false;
+            });
+        }
+    }
+
+    /**
+     * Applies the function to the value of the key under the leaf lock: The read and the write happen in a
+     * single descent, no other writer can interleave. The function is called exactly once (never on restarts).
+     *
+     * @param key Key.
+     * @param modify Called as modify(is_found, value); value is the current value if found (default-constructed
+     *  otherwise) and may be changed. Returns true to write the value (inserting the key if missing).
+     */
+    template<typename F>
+    Coroutine read_modify_write(const Key key, F modify) {
+        static_assert(is_out_of_line_values == false, "Out-of-line values are immutable; use insert().");
+        return modify_payload(key, std::move(modify));
+    }
+
+    /**
+     * Adds delta to the value of the key; missing keys are inserted with the value delta.
+     *
+     * @param result The value of the key afterward.
+     */
+    Coroutine add(const Key key, const Value delta, Value &result) {
+        return read_modify_write(key, [delta, &result](const bool is_found, Value &value) {
+            value = is_found ? Value(value + delta) : delta;
+            result = value;
+            return true;
+        });
     }
 
-    ~BTree() { delete root.load(); }
+    /**
+     * Sets the value of the key to desired if it exists and its value is expected.
+     *
+     * @param result The value of the key before (default-constructed if missing); equals expected on success.
+     */
+    Coroutine compare_and_set(const Key key, const Value expected, const Value desired, Value &result) {
+        return read_modify_write(key, [expected, desired, &result](const bool is_found, Value &value) {
+            result = value;
+            if (is_found && value == expected) {
+                value = desired;
+                return true;
+            }
+            return false;
+        });
+    }
+
+    /**
+     * Inserts or updates the key with the (in-line value or handle of the) value.
+     */
+    Coroutine insert_payload(const Key key, const Payload payload) {
+        return modify_payload(key, Assign{payload});
+    }
 
     /**
-     * Coroutinized insert_requests method that yields control-flow for prefetching.
+     * Writes a payload to the leaf of the key; see read_modify_write().
      */
-    Coroutine insert(const Key key, const Value value) {
+    template<typename F>
+    Coroutine modify_payload(const Key key, F modify) {
+        assert(snapshot.is_writable() && "The tree was restored from a read-only snapshot.");
         auto restart_count = 0U;
+
+        /// B-link: A leaf was split and written without locking the parent; the separator is posted afterward.
+        auto is_modified = false;
+        auto is_posting = false;
+        Key post_key{};
+        NodeBase *post_node = nullptr;
         restart:
-        if (restart_count++)
-            yield(restart_count);
+        co_await backoff(++restart_count);
         auto is_need_restart = false;
         auto tree_level = 0U;
+        const auto descent_key = is_posting ? post_key : key;
+
+        /// True, if the path took the last child of every inner node so far.
+        auto is_rightmost = true;
 
         // Current node
         auto *node = root.load();
         auto version_node = node->read_lock_or_restart(is_need_restart);
         if (is_need_restart || (node != root))
             goto restart;
+        if (synchronization == Synchronization::BLink && !move_right(node, version_node, descent_key))
+            goto restart;
 
         // Parent of current node
         BTreeInner<Key, PageSize> *parent = nullptr;
@@ -293,7 +787,8 @@ struct BTree {
                 }
                 // Split
                 Key sep;
-                auto *new_inner = inner->split(sep);
+                auto *new_inner = inner->split(sep, node_allocator, is_append_split(inner, is_rightmost));
+                count_node(new_inner);
                 if (parent)
                     parent->insert(sep, new_inner);
                 else
@@ -305,7 +800,21 @@ struct BTree {
                 goto restart;
             }
 
-            if (parent) {
+            /// Reached the parent of the split leaf (which has room, since full nodes were split on the way).
+            if (is_posting && inner->height == post_node->height + 1U) {
+                node->upgrade_to_write_lock_or_restart(version_node, is_need_restart);
+                if (is_need_restart)
+                    goto restart;
+                inner->insert(post_key, post_node);
+                node->write_unlock();
+                is_posting = false;
+                if (is_modified)
+                    co_return Annotation{};
+                restart_count = 0U;
+                goto restart;
+            }
+
+            if (parent && synchronization == Synchronization::LockCoupling) {
                 parent->read_unlock_or_restart(version_parent, is_need_restart);
                 if (is_need_restart)
                     goto restart;
@@ -313,7 +822,8 @@ struct BTree {
 
             parent = inner;
             version_parent = version_node;
-            const auto pos = inner->lowerBound(key);
+            const auto pos = inner->lowerBound(descent_key);
+            is_rightmost = is_rightmost && pos == inner->count;
 
             node = inner->children[pos];
             inner->check_or_restart(version_node, is_need_restart);
@@ -323,19 +833,62 @@ struct BTree {
             /**
              * Accessing the follow up node => Prefetch complete node
              */
-            node->prefetch<PageSize>();
-            co_await Annotation{};
+            co_await prefetch(node, inner->height - 1U, restart_count);
 
             version_node = node->read_lock_or_restart(is_need_restart);
             if (is_need_restart)
                 goto restart;
+            if (synchronization == Synchronization::BLink && !move_right(node, version_node, descent_key))
+                goto restart;
             ++tree_level;
         }
 
-        auto *leaf = static_cast<BTreeLeaf<Key, Value, PageSize> *>(node);
+        auto *leaf = static_cast<Leaf *>(node);
+
+        // Split leaf if full or contended
+        if (!leaf->canInsert(key) || is_contended(leaf)) {
+            if (synchronization == Synchronization::BLink && parent) {
+                // Only lock the leaf
+                node->upgrade_to_write_lock_or_restart(version_node, is_need_restart);
+                if (is_need_restart) {
+                    record_contention(node);
+                    goto restart;
+                }
+                // Split
+                Key sep;
+                leaf_versions.preserve(leaf);
+                auto *new_leaf = leaf->split(sep, node_allocator, is_append_split(leaf, is_rightmost));
+                leaf_versions.share(leaf, new_leaf);
+                leaf->contention.store(0U, std::memory_order_relaxed);
+
+                /// The new leaf is only reachable through the locked leaf, until the separator is posted.
+                auto *target = key <= sep ? leaf : new_leaf;
+                if (target->canInsert(key)) {
+                    modify_leaf(target, key, modify);
+                    is_modified = true;
+                }
+                node->write_unlock();
+
+                /// Post the separator to the parent, if it did not change; otherwise, descend again to find it.
+                parent->upgrade_to_write_lock_or_restart(version_parent, is_need_restart);
+                if (is_need_restart == false) {
+                    if (parent->isFull() == false) {
+                        parent->insert(sep, new_leaf);
+                        parent->write_unlock();
+                        if (is_modified)
+                            co_return Annotation{};
+                        restart_count = 0U;
+                        goto restart;
+                    }
+                    parent->write_unlock();
+                }
+                is_posting = true;
+                post_key = sep;
+                post_node = new_leaf;
+                restart_count = 0U;
+                goto restart;
+            }
 
-        // Split leaf if full
-        if (leaf->count == leaf->maxEntries) {
             // Lock
             if (parent) {
                 parent->upgrade_to_write_lock_or_restart(version_parent, is_need_restart);
@@ -346,6 +899,7 @@ struct BTree {
             if (is_need_restart) {
                 if (parent)
                     parent->write_unlock();
+                record_contention(node);
                 goto restart;
             }
             if (!parent && (node != root)) { // there's a new parent
@@ -354,7 +908,10 @@ struct BTree {
             }
             // Split
             Key sep;
-            auto *new_leaf = leaf->split(sep);
+            leaf_versions.preserve(leaf);
+            auto *new_leaf = leaf->split(sep, node_allocator, is_append_split(leaf, is_rightmost));
+            leaf_versions.share(leaf, new_leaf);
+            leaf->contention.store(0U, std::memory_order_relaxed);
             if (parent)
                 parent->insert(sep, new_leaf);
             else
@@ -367,9 +924,11 @@ struct BTree {
         } else {
             // only lock leaf node
             node->upgrade_to_write_lock_or_restart(version_node, is_need_restart);
-            if (is_need_restart)
+            if (is_need_restart) {
+                record_contention(node);
                 goto restart;
-            if (parent) {
+            }
+            if (parent && synchronization == Synchronization::LockCoupling) {
                 parent->read_unlock_or_restart(version_parent, is_need_restart);
                 if (is_need_restart) {
                     node->write_unlock();
@@ -377,19 +936,51 @@ struct BTree {
                 }
             }
 
-            leaf->insert(key, value);
-
+            modify_leaf(leaf, key, modify);
             node->write_unlock();
 
             co_return Annotation{}; // success
         }
     }
 
+    /**
+     * Applies the function of modify_payload() to the key in the write-locked leaf; logs and caches the written payload.
+     */
+    template<typename F>
+    void modify_leaf(Leaf *leaf, const Key key, F &modify) {
+        auto payload = Payload{};
+        if constexpr (std::is_same_v<F, Assign>) {
+            payload = modify.payload;
+        } else {
+            const auto is_found = leaf->find(key, payload);
+            if (modify(is_found, payload) == false) {
+                return;
+            }
+        }
+
+        leaf_versions.preserve(leaf);
+        const auto is_inserted = leaf->insert(key, payload);
+        if constexpr (is_out_of_line_values == false) {
+            /// Only existing keys can be cached.
+            if (is_inserted == false && hot_key_cache != nullptr) {
+                hot_key_cache->update(key, payload);
+            }
+        }
+        if (write_ahead_log != nullptr) {
+            using Operation = typename WriteAheadLog<Key, Value>::Operation;
+            if constexpr (is_out_of_line_values) {
+                write_ahead_log->append(is_inserted ? Operation::Insert : Operation::Update, key,
+                                        *value_heap.get(payload));
+            } else {
+                write_ahead_log->append(is_inserted ? Operation::Insert : Operation::Update, key, payload);
+            }
+        }
+    }
+
     Coroutine lookup(const Key key, Value &result) {
         auto restart_count = 0U;
         restart:
-        if (restart_count++)
-            yield(restart_count);
+        co_await backoff(++restart_count);
         auto is_need_restart = false;
         auto tree_level = 0U;
 
@@ -402,6 +993,8 @@ struct BTree {
         auto version_node = node->read_lock_or_restart(is_need_restart);
         if (is_need_restart || (node != root))
             goto restart;
+        if (synchronization == Synchronization::BLink && !move_right(node, version_node, key))
+            goto restart;
 
         // Parent of current node
         BTreeInner<Key, PageSize> *parent = nullptr;
@@ -410,7 +1003,7 @@ struct BTree {
         while (node->type == PageType::BTreeInner) {
             auto *inner = static_cast<BTreeInner<Key, PageSize> *>(node);
 
-            if (parent) {
+            if (parent && synchronization == Synchronization::LockCoupling) {
                 parent->read_unlock_or_restart(version_parent, is_need_restart);
                 if (is_need_restart)
                     goto restart;
@@ -429,43 +1022,939 @@ struct BTree {
             /**
              * Accessing the follow up node => Prefetch complete node
              */
-            node->prefetch<PageSize>();
-            co_await Annotation{};
+            co_await prefetch(node, inner->height - 1U, restart_count);
 
             version_node = node->read_lock_or_restart(is_need_restart);
             if (is_need_restart)
                 goto restart;
+            if (synchronization == Synchronization::BLink && !move_right(node, version_node, key))
+                goto restart;
 
             ++tree_level;
         }
 
-        auto *leaf = static_cast<BTreeLeaf<Key, Value, PageSize> *>(node);
+        read_leaf:
+        auto *leaf = static_cast<Leaf *>(node);
 
-        const auto pos = leaf->lowerBound(key);
-        if ((pos < leaf->count) && (leaf->keys[pos] == key)) {
-            result = leaf->payloads[pos];
-        }
-        if (parent) {
+        Payload payload{};
+        const auto is_found = leaf->find(key, payload);
+        if (parent && synchronization == Synchronization::LockCoupling) {
             parent->read_unlock_or_restart(version_parent, is_need_restart);
             if (is_need_restart)
                 goto restart;
         }
         node->read_unlock_or_restart(version_node, is_need_restart);
-        if (is_need_restart)
+        if (is_need_restart) {
+            record_contention(node);
+            /// B-link: Read the leaf again (moving right, if it was split) instead of descending from the root.
+            if (synchronization == Synchronization::BLink) {
+                is_need_restart = false;
+                version_node = node->read_lock_or_restart(is_need_restart);
+                if (is_need_restart == false && move_right(node, version_node, key))
+                    goto read_leaf;
+            }
             goto restart;
+        }
+
+        if constexpr (is_out_of_line_values == false) {
+            if (is_found && hot_key_cache != nullptr) {
+                /// A writer that modified the leaf since it was read might have missed the admitted key.
+                hot_key_cache->admit(key, payload);
+                node->read_unlock_or_restart(version_node, is_need_restart);
+                if (is_need_restart) {
+                    hot_key_cache->invalidate(key);
+                }
+            }
+        }
+
+        if (is_found) {
+            if constexpr (is_out_of_line_values) {
+                /**
+                 * Second stage: The value is stored out-of-line => Prefetch the value.
+                 * Values are immutable, the handle stays valid without holding the leaf.
+                 */
+                const auto *value = value_heap.get(payload);
+                SWPrefetcher::prefetch<0U, sizeof(Value) / cacheLineSize + 1U>(const_cast<Value *>(value));
+                co_await Annotation{Coroutine::Stage::ValueLookup};
+                result = *value;
+            } else {
+                result = payload;
+            }
+        }
 
         co_return Annotation{};
     }
 
-    void makeRoot(Key k, NodeBase *leftChild, NodeBase *rightChild) {
-        void *align_ptr = std::aligned_alloc(PageSize, sizeof(BTreeInner<Key, PageSize>));
-        auto inner = new(align_ptr) BTreeInner<Key, PageSize>();
-        inner->count = 1;
-        inner->keys[0] = k;
-        inner->children[0] = leftChild;
-        inner->children[1] = rightChild;
-        root = inner;
-    }
+    /**
+     * Coroutinized lookup in a read view: Returns the value the key had when the view was opened.
+     * Writes to the leaf after the view was opened do not make the lookup restart, since the writer
+     * preserved an image of the leaf for the view; only writes that were in flight when the view was
+     * opened and splits of inner nodes do.
+     *
+     * @param view View opened by open_read_view().
+     * @param key Key to look up.
+     * @param result Value of the key (unchanged if the key did not exist in the view).
+     */
+    Coroutine lookup(const ReadView view, const Key key, Value &result) {
+        auto restart_count = 0U;
+        restart:
+        co_await backoff(++restart_count);
+        auto is_need_restart = false;
+
+        auto *node = root.load();
+        auto version_node = node->read_lock_or_restart(is_need_restart);
+        if (is_need_restart || (node != root))
+            goto restart;
+
+        // Parent of current node
+        BTreeInner<Key, PageSize> *parent = nullptr;
+        std::uint64_t version_parent;
+
+        while (node->type == PageType::BTreeInner) {
+            auto *inner = static_cast<BTreeInner<Key, PageSize> *>(node);
+
+            if (parent) {
+                parent->read_unlock_or_restart(version_parent, is_need_restart);
+                if (is_need_restart)
+                    goto restart;
+            }
+
+            parent = inner;
+            version_parent = version_node;
+
+            const auto pos = inner->lowerBound(key);
+            node = inner->children[pos];
+
+            inner->check_or_restart(version_node, is_need_restart);
+            if (is_need_restart)
+                goto restart;
+
+            /**
+             * Accessing the follow up node => Prefetch complete node
+             */
+            co_await prefetch(node, inner->height - 1U, restart_count);
+
+            /// A locked leaf is read from its image (if preserved for the view).
+            version_node = node->read_lock_or_restart(is_need_restart);
+            if (is_need_restart && node->type == PageType::BTreeInner)
+                goto restart;
+        }
+
+        auto *leaf = static_cast<Leaf *>(node);
+
+        Payload payload{};
+        auto is_found = false;
+        if (const auto *image = leaf_versions.image(leaf, view); image != nullptr) {
+            is_found = const_cast<Leaf *>(image)->find(key, payload);
+        } else {
+            if (is_need_restart == false) {
+                is_found = leaf->find(key, payload);
+                node->read_unlock_or_restart(version_node, is_need_restart);
+            }
+
+            /// The leaf was modified meanwhile: The writer preserved the image, unless it wrote before the view.
+            if (is_need_restart) {
+                const auto *modified_image = leaf_versions.image(leaf, view);
+                if (modified_image == nullptr) {
+                    goto restart;
+                }
+                is_found = const_cast<Leaf *>(modified_image)->find(key, payload);
+            }
+        }
+        if (parent) {
+            parent->read_unlock_or_restart(version_parent, is_need_restart);
+            if (is_need_restart)
+                goto restart;
+        }
+
+        if (is_found) {
+            if constexpr (is_out_of_line_values) {
+                /// Values are immutable, the handle of the image stays valid.
+                const auto *value = value_heap.get(payload);
+                SWPrefetcher::prefetch<0U, sizeof(Value) / cacheLineSize + 1U>(const_cast<Value *>(value));
+                co_await Annotation{Coroutine::Stage::ValueLookup};
+                result = *value;
+            } else {
+                result = payload;
+            }
+        }
+
+        co_return Annotation{};
+    }
+
+    /**
+     * Coroutinized insert of a batch of entries, sorted by key. The tree is descended once per
+     * distinct leaf: All entries that belong to the same leaf are inserted under a single lock.
+     * For equal keys, the latter entry wins.
+     *
+     * @param begin First entry of the batch; entries have to stay valid until the coroutine finished.
+     * @param end Entry behind the last one of the batch.
+     */
+    Coroutine insert_batch(const std::pair<Key, Value> *begin, const std::pair<Key, Value> *end) {
+        assert(snapshot.is_writable() && "The tree was restored from a read-only snapshot.");
+        auto restart_count = 0U;
+        restart:
+        co_await backoff(++restart_count);
+        if (begin == end)
+            co_return Annotation{};
+        auto is_need_restart = false;
+
+        /// Keys of the leaf are at most this separator (if bounded), taken from the closest inner node on the path.
+        auto is_bounded = false;
+        Key upper_bound{};
+
+        // Current node
+        auto *node = root.load();
+        auto version_node = node->read_lock_or_restart(is_need_restart);
+        if (is_need_restart || (node != root))
+            goto restart;
+        if (synchronization == Synchronization::BLink && !move_right(node, version_node, begin->first))
+            goto restart;
+
+        // Parent of current node
+        BTreeInner<Key, PageSize> *parent = nullptr;
+        std::uint64_t version_parent;
+
+        while (node->type == PageType::BTreeInner) {
+            auto *inner = static_cast<BTreeInner<Key, PageSize> *>(node);
+
+            // Split eagerly if full
+            if (inner->isFull()) {
+                // Lock
+                if (parent) {
+                    parent->upgrade_to_write_lock_or_restart(version_parent, is_need_restart);
+                    if (is_need_restart)
+                        goto restart;
+                }
+                node->upgrade_to_write_lock_or_restart(version_node, is_need_restart);
+                if (is_need_restart) {
+                    if (parent)
+                        parent->write_unlock();
+                    goto restart;
+                }
+                if (!parent && (node != root)) { // there's a new parent
+                    node->write_unlock();
+                    goto restart;
+                }
+                // Split
+                Key sep;
+                auto *new_inner = inner->split(sep, node_allocator, is_append_split(inner, !is_bounded));
+                count_node(new_inner);
+                if (parent)
+                    parent->insert(sep, new_inner);
+                else
+                    makeRoot(sep, inner, new_inner);
+                // Unlock and restart
+                node->write_unlock();
+                if (parent)
+                    parent->write_unlock();
+                goto restart;
+            }
+
+            if (parent && synchronization == Synchronization::LockCoupling) {
+                parent->read_unlock_or_restart(version_parent, is_need_restart);
+                if (is_need_restart)
+                    goto restart;
+            }
+
+            parent = inner;
+            version_parent = version_node;
+            const auto pos = inner->lowerBound(begin->first);
+            if (pos < inner->count) {
+                is_bounded = true;
+                upper_bound = inner->keys[pos];
+            }
+
+            node = inner->children[pos];
+            inner->check_or_restart(version_node, is_need_restart);
+            if (is_need_restart)
+                goto restart;
+
+            /**
+             * Accessing the follow up node => Prefetch complete node
+             */
+            co_await prefetch(node, inner->height - 1U, restart_count);
+
+            version_node = node->read_lock_or_restart(is_need_restart);
+            if (is_need_restart)
+                goto restart;
+            if (synchronization == Synchronization::BLink && !move_right(node, version_node, begin->first))
+                goto restart;
+        }
+
+        auto *leaf = static_cast<Leaf *>(node);
+
+        /// The leaf may have been split after the parent was read (B-link): Its own high key bounds it.
+        if (leaf->next != nullptr && (!is_bounded || leaf->highKey < upper_bound)) {
+            is_bounded = true;
+            upper_bound = leaf->highKey;
+        }
+
+        // Split leaf if full or contended
+        if (!leaf->canInsert(begin->first) || is_contended(leaf)) {
+            // Lock
+            if (parent) {
+                parent->upgrade_to_write_lock_or_restart(version_parent, is_need_restart);
+                if (is_need_restart)
+                    goto restart;
+            }
+            node->upgrade_to_write_lock_or_restart(version_node, is_need_restart);
+            if (is_need_restart) {
+                if (parent)
+                    parent->write_unlock();
+                record_contention(node);
+                goto restart;
+            }
+            if (!parent && (node != root)) { // there's a new parent
+                node->write_unlock();
+                goto restart;
+            }
+            // Split
+            Key sep;
+            leaf_versions.preserve(leaf);
+            auto *new_leaf = leaf->split(sep, node_allocator, is_append_split(leaf, !is_bounded));
+            leaf_versions.share(leaf, new_leaf);
+            leaf->contention.store(0U, std::memory_order_relaxed);
+            if (parent)
+                parent->insert(sep, new_leaf);
+            else
+                makeRoot(sep, leaf, new_leaf);
+            // Unlock and restart
+            node->write_unlock();
+            if (parent)
+                parent->write_unlock();
+            goto restart;
+        }
+
+        // only lock leaf node
+        node->upgrade_to_write_lock_or_restart(version_node, is_need_restart);
+        if (is_need_restart) {
+            record_contention(node);
+            goto restart;
+        }
+        if (parent && synchronization == Synchronization::LockCoupling) {
+            parent->read_unlock_or_restart(version_parent, is_need_restart);
+            if (is_need_restart) {
+                node->write_unlock();
+                goto restart;
+            }
+        }
+
+        /// Insert entries until the next one belongs to another leaf or needs a split.
+        /// Out-of-line values are written to the heap under the lock, since the leaf is only known here.
+        leaf_versions.preserve(leaf);
+        do {
+            const auto &[key, value] = *begin;
+            auto payload = Payload{};
+            if constexpr (is_out_of_line_values) {
+                payload = value_heap.allocate(value);
+            } else {
+                payload = value;
+            }
+
+            const auto is_inserted = leaf->insert(key, payload);
+            if constexpr (is_out_of_line_values == false) {
+                if (is_inserted == false && hot_key_cache != nullptr) {
+                    hot_key_cache->update(key, payload);
+                }
+            }
+            if (write_ahead_log != nullptr) {
+                using Operation = typename WriteAheadLog<Key, Value>::Operation;
+                write_ahead_log->append(is_inserted ? Operation::Insert : Operation::Update, key, value);
+            }
+        } while (++begin != end && (!is_bounded || begin->first <= upper_bound) && leaf->canInsert(begin->first));
+
+        node->write_unlock();
+
+        /// Descend again for the remaining entries; this is progress, not a conflict.
+        restart_count = 0U;
+        goto restart;
+    }
+
+    /**
+     * Coroutinized range scan: Reads up to count entries with keys not smaller than from, leaf by leaf.
+     * The scan descends again for the next leaf, starting behind the upper separator (or the high key)
+     * of the current one.
+     *
+     * @param from Smallest key to read.
+     * @param count Number of entries to read.
+     * @param result Value of the last entry read.
+     */
+    Coroutine scan(const Key from, const std::uint64_t count, Value &result) {
+        auto restart_count = 0U;
+        auto key = from;
+        auto count_scanned = std::uint64_t{0U};
+        restart:
+        co_await backoff(++restart_count);
+        auto is_need_restart = false;
+
+        /// Keys of the leaf are at most this separator (if bounded), taken from the closest inner node on the path.
+        auto is_bounded = false;
+        Key upper_bound{};
+
+        auto *node = root.load();
+        auto version_node = node->read_lock_or_restart(is_need_restart);
+        if (is_need_restart || (node != root))
+            goto restart;
+        if (synchronization == Synchronization::BLink && !move_right(node, version_node, key))
+            goto restart;
+
+        // Parent of current node
+        BTreeInner<Key, PageSize> *parent = nullptr;
+        std::uint64_t version_parent;
+
+        while (node->type == PageType::BTreeInner) {
+            auto *inner = static_cast<BTreeInner<Key, PageSize> *>(node);
+
+            if (parent && synchronization == Synchronization::LockCoupling) {
+                parent->read_unlock_or_restart(version_parent, is_need_restart);
+                if (is_need_restart)
+                    goto restart;
+            }
+
+            parent = inner;
+            version_parent = version_node;
+
+            const auto pos = inner->lowerBound(key);
+            if (pos < inner->count) {
+                is_bounded = true;
+                upper_bound = inner->keys[pos];
+            }
+            node = inner->children[pos];
+
+            inner->check_or_restart(version_node, is_need_restart);
+            if (is_need_restart)
+                goto restart;
+
+            /**
+             * Accessing the follow up node => Prefetch complete node
+             */
+            co_await prefetch(node, inner->height - 1U, restart_count);
+
+            version_node = node->read_lock_or_restart(is_need_restart);
+            if (is_need_restart)
+                goto restart;
+            if (synchronization == Synchronization::BLink && !move_right(node, version_node, key))
+                goto restart;
+        }
+
+        auto *leaf = static_cast<Leaf *>(node);
+
+        /// The leaf may have been split after the parent was read (B-link): Its own high key bounds it.
+        if (leaf->next != nullptr && (!is_bounded || leaf->highKey < upper_bound)) {
+            is_bounded = true;
+            upper_bound = leaf->highKey;
+        }
+
+        /// Entries read from this leaf count only after the leaf was validated.
+        auto count_leaf = std::uint64_t{0U};
+        Payload last_payload{};
+        leaf->scanFrom(key, [&](const Key, const Payload &payload) {
+            if (count_scanned + count_leaf == count) {
+                return false;
+            }
+            last_payload = payload;
+            ++count_leaf;
+            return true;
+        });
+        if (parent && synchronization == Synchronization::LockCoupling) {
+            parent->read_unlock_or_restart(version_parent, is_need_restart);
+            if (is_need_restart)
+                goto restart;
+        }
+        node->read_unlock_or_restart(version_node, is_need_restart);
+        if (is_need_restart) {
+            record_contention(node);
+            goto restart;
+        }
+
+        if (count_leaf > 0U) {
+            count_scanned += count_leaf;
+            if constexpr (is_out_of_line_values) {
+                result = *value_heap.get(last_payload);
+            } else {
+                result = last_payload;
+            }
+        }
+
+        /// Continue with the next leaf; this is progress, not a conflict.
+        if (count_scanned < count && is_bounded && upper_bound < std::numeric_limits<Key>::max()) {
+            key = upper_bound + 1U;
+            restart_count = 0U;
+            goto restart;
+        }
+
+        co_return Annotation{};
+    }
+
+    /**
+     * Coroutinized range scan in a read view: Reads up to count entries with keys not smaller than from,
+     * as they were when the view was opened. Like lookup(view, ...), the scan reads preserved images
+     * of leaves that were modified after the view was opened instead of restarting.
+     *
+     * @param view View opened by open_read_view().
+     * @param from Smallest key to read.
+     * @param count Number of entries to read.
+     * @param result Value of the last entry read.
+     */
+    Coroutine scan(const ReadView view, const Key from, const std::uint64_t count, Value &result) {
+        auto restart_count = 0U;
+        auto key = from;
+        auto count_scanned = std::uint64_t{0U};
+        restart:
+        co_await backoff(++restart_count);
+        auto is_need_restart = false;
+
+        /// Keys of the leaf are at most this separator (if bounded), taken from the closest inner node on the path.
+        auto is_bounded = false;
+        Key upper_bound{};
+
+        auto *node = root.load();
+        auto version_node = node->read_lock_or_restart(is_need_restart);
+        if (is_need_restart || (node != root))
+            goto restart;
+
+        // Parent of current node
+        BTreeInner<Key, PageSize> *parent = nullptr;
+        std::uint64_t version_parent;
+
+        while (node->type == PageType::BTreeInner) {
+            auto *inner = static_cast<BTreeInner<Key, PageSize> *>(node);
+
+            if (parent) {
+                parent->read_unlock_or_restart(version_parent, is_need_restart);
+                if (is_need_restart)
+                    goto restart;
+            }
+
+            parent = inner;
+            version_parent = version_node;
+
+            const auto pos = inner->lowerBound(key);
+            if (pos < inner->count) {
+                is_bounded = true;
+                upper_bound = inner->keys[pos];
+            }
+            node = inner->children[pos];
+
+            inner->check_or_restart(version_node, is_need_restart);
+            if (is_need_restart)
+                goto restart;
+
+            /**
+             * Accessing the follow up node => Prefetch complete node
+             */
+            co_await prefetch(node, inner->height - 1U, restart_count);
+
+            /// A locked leaf is read from its image (if preserved for the view).
+            version_node = node->read_lock_or_restart(is_need_restart);
+            if (is_need_restart && node->type == PageType::BTreeInner)
+                goto restart;
+        }
+
+        auto *leaf = static_cast<Leaf *>(node);
+
+        /// Entries read from this leaf count only after the leaf was validated. Images of split leaves
+        /// hold keys of the new leaves as well; these are read when the scan reaches the new leaves.
+        auto count_leaf = std::uint64_t{0U};
+        Payload last_payload{};
+        const auto visit = [&](const Key entry_key, const Payload &payload) {
+            if (count_scanned + count_leaf == count || (is_bounded && upper_bound < entry_key)) {
+                return false;
+            }
+            last_payload = payload;
+            ++count_leaf;
+            return true;
+        };
+        if (const auto *image = leaf_versions.image(leaf, view); image != nullptr) {
+            const_cast<Leaf *>(image)->scanFrom(key, visit);
+        } else {
+            if (is_need_restart == false) {
+                leaf->scanFrom(key, visit);
+                node->read_unlock_or_restart(version_node, is_need_restart);
+            }
+
+            /// The leaf was modified meanwhile: The writer preserved the image, unless it wrote before the view.
+            if (is_need_restart) {
+                const auto *modified_image = leaf_versions.image(leaf, view);
+                if (modified_image == nullptr) {
+                    goto restart;
+                }
+                count_leaf = 0U;
+                const_cast<Leaf *>(modified_image)->scanFrom(key, visit);
+            }
+        }
+        if (parent) {
+            parent->read_unlock_or_restart(version_parent, is_need_restart);
+            if (is_need_restart)
+                goto restart;
+        }
+
+        if (count_leaf > 0U) {
+            count_scanned += count_leaf;
+            if constexpr (is_out_of_line_values) {
+                result = *value_heap.get(last_payload);
+            } else {
+                result = last_payload;
+            }
+        }
+
+        /// Continue with the next leaf; this is progress, not a conflict.
+        if (count_scanned < count && is_bounded && upper_bound < std::numeric_limits<Key>::max()) {
+            key = upper_bound + 1U;
+            restart_count = 0U;
+            goto restart;
+        }
+
+        co_return Annotation{};
+    }
+
+    /**
+     * Coroutinized remove method that yields control-flow for prefetching.
+     * Leaves are not merged when they underflow.
+     */
+    Coroutine remove(const Key key) {
+        assert(snapshot.is_writable() && "The tree was restored from a read-only snapshot.");
+        auto restart_count = 0U;
+        restart:
+        co_await backoff(++restart_count);
+        auto is_need_restart = false;
+
+        auto *node = root.load();
+        auto version_node = node->read_lock_or_restart(is_need_restart);
+        if (is_need_restart || (node != root))
+            goto restart;
+        if (synchronization == Synchronization::BLink && !move_right(node, version_node, key))
+            goto restart;
+
+        // Parent of current node
+        BTreeInner<Key, PageSize> *parent = nullptr;
+        std::uint64_t version_parent;
+
+        while (node->type == PageType::BTreeInner) {
+            auto *inner = static_cast<BTreeInner<Key, PageSize> *>(node);
+
+            if (parent && synchronization == Synchronization::LockCoupling) {
+                parent->read_unlock_or_restart(version_parent, is_need_restart);
+                if (is_need_restart)
+                    goto restart;
+            }
+
+            parent = inner;
+            version_parent = version_node;
+
+            const auto pos = inner->lowerBound(key);
+            node = inner->children[pos];
+
+            inner->check_or_restart(version_node, is_need_restart);
+            if (is_need_restart)
+                goto restart;
+
+            /**
+             * Accessing the follow up node => Prefetch complete node
+             */
+            co_await prefetch(node, inner->height - 1U, restart_count);
+
+            version_node = node->read_lock_or_restart(is_need_restart);
+            if (is_need_restart)
+                goto restart;
+            if (synchronization == Synchronization::BLink && !move_right(node, version_node, key))
+                goto restart;
+        }
+
+        // only lock leaf node
+        node->upgrade_to_write_lock_or_restart(version_node, is_need_restart);
+        if (is_need_restart) {
+            record_contention(node);
+            goto restart;
+        }
+        if (parent && synchronization == Synchronization::LockCoupling) {
+            parent->read_unlock_or_restart(version_parent, is_need_restart);
+            if (is_need_restart) {
+                node->write_unlock();
+                goto restart;
+            }
+        }
+
+        auto *leaf = static_cast<Leaf *>(node);
+        leaf_versions.preserve(leaf);
+        if (leaf->remove(key)) {
+            if constexpr (is_out_of_line_values == false) {
+                if (hot_key_cache != nullptr) {
+                    hot_key_cache->invalidate(key);
+                }
+            }
+            if (write_ahead_log != nullptr) {
+                write_ahead_log->append(WriteAheadLog<Key, Value>::Operation::Remove, key, Value{});
+            }
+        }
+
+        node->write_unlock();
+
+        co_return Annotation{};
+    }
+
+    /**
+     * Visits all entries in key order. Nodes are read without locks: The tree must not be modified
+     * meanwhile (e.g., while entries are moved to another tree).
+     *
+     * @param visit Callable invoked with every key and value.
+     */
+    template<typename F>
+    void for_each(F &&visit) {
+        for_each(root.load(), visit);
+    }
+
+    /**
+     * Opens a point-in-time view for lookup(view, ...) and scan(view, ...). Writers are not blocked, but copy
+     * a leaf on its first modification after the view was opened; close the view to free the copies.
+     *
+     * @throws std::runtime_error if the tree is synchronized as a B-link tree.
+     */
+    ReadView open_read_view() {
+        /// Views descend with lock coupling: They neither move right nor bound their reads by high keys.
+        if (synchronization != Synchronization::LockCoupling) {
+            throw std::runtime_error{"Read views need lock coupling; the tree is synchronized as a B-link tree."};
+        }
+        return leaf_versions.open();
+    }
+
+    void close_read_view(const ReadView view) { leaf_versions.close(view); }
+
+    /**
+     * Answers the lookup from the hot-key cache (if any), without creating a coroutine.
+     *
+     * @return True, if the key was cached.
+     */
+    bool lookup_cached(const Key key, Value &result) {
+        if constexpr (is_out_of_line_values) {
+            return false;
+        } else {
+            return hot_key_cache != nullptr && hot_key_cache->lookup(key, result);
+        }
+    }
+
+    void makeRoot(Key k, NodeBase *leftChild, NodeBase *rightChild) {
+        void *align_ptr = node_allocator.allocate(sizeof(BTreeInner<Key, PageSize>), PageSize);
+        auto inner = new(align_ptr) BTreeInner<Key, PageSize>();
+        inner->height = leftChild->height + 1U;
+        inner->count = 1;
+        inner->keys[0] = k;
+        inner->children[0] = leftChild;
+        inner->children[1] = rightChild;
+        count_node(inner);
+        root = inner;
+    }
+
+    /**
+     * B-link: Moves right while the key lies beyond the high key of the node, i.e., the node was split
+     * after its parent was read. The caller validates the version of the node it ends up with.
+     *
+     * @return False, if a node was modified while following its link (the descent restarts).
+     */
+    bool move_right(NodeBase *&node, std::uint64_t &version, const Key key) {
+        while (true) {
+            auto *next = node->next;
+            const auto high_key = node->type == PageType::BTreeInner
+                                  ? static_cast<BTreeInner<Key, PageSize> *>(node)->highKey
+                                  : static_cast<Leaf *>(node)->highKey;
+            if (next == nullptr || key <= high_key) {
+                return true;
+            }
+
+            auto is_need_restart = false;
+            node->check_or_restart(version, is_need_restart);
+            if (is_need_restart) {
+                return false;
+            }
+            node = next;
+            version = node->read_lock_or_restart(is_need_restart);
+            if (is_need_restart) {
+                return false;
+            }
+        }
+    }
+
+    template<typename F>
+    void for_each(NodeBase *node, F &visit) {
+        if (node->type == PageType::BTreeInner) {
+            auto *inner = static_cast<BTreeInner<Key, PageSize> *>(node);
+            for (auto child = 0U; child <= inner->count; ++child) {
+                for_each(inner->children[child], visit);
+            }
+            return;
+        }
+
+        static_cast<Leaf *>(node)->scanFrom(std::numeric_limits<Key>::min(), [&](const Key key, const Payload &payload) {
+            if constexpr (is_out_of_line_values) {
+                visit(key, *value_heap.get(payload));
+            } else {
+                visit(key, payload);
+            }
+            return true;
+        });
+    }
+
+    /**
+     * Time-ordered keys always hit the rightmost node of a level, even if they arrive slightly out of order;
+     * other sequential streams are detected by the node.
+     *
+     * @param node Node to split.
+     * @param is_rightmost True, if the node is the last one of its level.
+     * @return True, if the node should be split near the end (see SplitPolicy).
+     */
+    [[nodiscard]] bool is_append_split(const NodeBase *node, const bool is_rightmost) const noexcept {
+        return split_policy == SplitPolicy::Adaptive && (is_rightmost || node->isSequential());
+    }
+
+    /**
+     * Counts an inner node created by a split (or restored from a snapshot).
+     */
+    void count_node(const NodeBase *node) noexcept {
+        count_nodes_per_height[node->height].fetch_add(1U, std::memory_order_relaxed);
+    }
+
+    /**
+     * Reports height, nodes per level, and memory footprint of the tree. Node counts are maintained
+     * by splits and read in O(height); entries and fill require scanning all nodes. Scanning reads the
+     * nodes without locks, i.e., the entries are approximate while the tree is modified concurrently.
+     *
+     * @param is_scan_nodes Scan all nodes to count entries and fill.
+     * @return Statistics of the tree.
+     */
+    [[nodiscard]] TreeStatistics statistics(const bool is_scan_nodes = true) const {
+        using Inner = BTreeInner<Key, PageSize>;
+
+        auto *root_node = root.load();
+        const auto root_height = root_node->height;
+
+        auto statistics = TreeStatistics{};
+        statistics.page_size = PageSize;
+        statistics.is_scanned = is_scan_nodes;
+
+        /// Leaves are the nodes allocated by the tree that are not inner nodes; inner nodes are counted after
+        /// they were allocated, so counting them before reading the allocated bytes keeps the difference positive.
+        auto count_allocated_inner_nodes = 0ULL;
+        for (auto height = 1U; height < count_nodes_per_height.size(); ++height) {
+            count_allocated_inner_nodes += count_nodes_per_height[height].load(std::memory_order_relaxed);
+        }
+
+        const auto allocated_node_bytes = node_allocator.allocated_bytes();
+        statistics.allocated_bytes = allocated_node_bytes;
+        statistics.mapped_bytes = node_allocator.mapped_bytes();
+        if (snapshot.is_mapped()) {
+            statistics.allocated_bytes += snapshot.size();
+            statistics.mapped_bytes += snapshot.size();
+        }
+        if constexpr (is_out_of_line_values) {
+            statistics.value_bytes = value_heap.size() * sizeof(Value);
+        }
+
+        if (snapshot.is_mapped()) {
+            count_allocated_inner_nodes -= snapshot.header().count_inner_nodes;
+        }
+        const auto count_leaves = count_nodes_per_height[0U].load(std::memory_order_relaxed) +
+                                  (allocated_node_bytes - count_allocated_inner_nodes * sizeof(Inner)) /
+                                  sizeof(Leaf);
+
+        /// Levels are ordered from the root (highest) to the leaves (height 0).
+        statistics.levels.resize(root_height + 1U);
+        for (auto level = 0U; level <= root_height; ++level) {
+            auto &fill = statistics.levels[level];
+            fill.height = root_height - level;
+            fill.count_nodes = fill.height > 0U ? count_nodes_per_height[fill.height].load(std::memory_order_relaxed)
+                                                : count_leaves;
+            fill.capacity = fill.height > 0U ? Inner::maxEntries : Leaf::maxEntries;
+            fill.lowest_fill = is_scan_nodes ? 1. : 0.;
+        }
+
+        if (is_scan_nodes) {
+            auto stack = std::vector<NodeBase *>{root_node};
+            while (stack.empty() == false) {
+                auto *node = stack.back();
+                stack.pop_back();
+
+                /// Inner nodes hold one more child than keys; the capacity of (compressed) leaves depends on their keys.
+                auto &fill = statistics.levels[root_height - node->height];
+                const auto entries = node->type == PageType::BTreeInner ? node->count + 1U : node->count;
+                const auto capacity = node->type == PageType::BTreeInner
+                                      ? Inner::maxEntries : static_cast<const Leaf *>(node)->entryCapacity();
+                fill.count_entries += entries;
+                fill.total_capacity += capacity;
+                fill.lowest_fill = std::min(fill.lowest_fill, double(entries) / double(capacity));
+
+                if (node->type == PageType::BTreeInner) {
+                    auto *inner = static_cast<Inner *>(node);
+                    stack.insert(stack.end(), inner->children, inner->children + inner->count + 1U);
+                }
+            }
+        }
+
+        return statistics;
+    }
+
+    /**
+     * Counts a conflicting access to the leaf that made a request restart.
+     * The counter is not exact: Concurrent increments may get lost, which only delays contention splitting.
+     */
+    static void record_contention(NodeBase *leaf) {
+        const auto contention = leaf->contention.load(std::memory_order_relaxed);
+        if (contention < std::numeric_limits<std::uint8_t>::max()) {
+            leaf->contention.store(contention + 1U, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @return True, if the leaf caused enough restarts to be split before it is full.
+     */
+    [[nodiscard]] bool is_contended(const Leaf *leaf) const noexcept {
+        return contention_split_threshold > 0U && leaf->count >= 2U &&
+               leaf->contention.load(std::memory_order_relaxed) >= contention_split_threshold;
+    }
+
+    /**
+     * @param height Height of the node prefetched before suspending, or Annotation::no_height.
+     * @param restart_count Passes of the request so far (restarts plus one).
+     * @return Annotation of a suspension, read by the executor (e.g., for tracing).
+     */
+    [[nodiscard]] static Annotation suspension(const std::uint32_t height, const std::uint32_t restart_count) noexcept {
+        return Annotation{std::uint8_t(height), std::uint16_t(restart_count - 1U)};
+    }
+
+    /**
+     * Prefetches the node the descent continues with.
+     *
+     * @param node Node to prefetch.
+     * @param height Height of the node.
+     * @param restart_count Passes of the request so far (restarts plus one).
+     * @return Annotation to suspend with while the node is fetched.
+     */
+    [[nodiscard]] static Annotation prefetch(NodeBase *node, const std::uint32_t height,
+                                             const std::uint32_t restart_count) noexcept {
+        node->prefetch<PageSize>();
+        return suspension(height, restart_count);
+    }
+
+    /**
+     * Backs off before a request restarts, according to the backoff_policy; the first pass continues right away.
+     *
+     * @param restart_count Passes of the request so far, including the upcoming one.
+     * @return Awaited by the request: Suspends (BackoffPolicy::Suspend) or continues after spinning.
+     */
+    [[nodiscard]] RestartBackoff backoff(const std::uint32_t restart_count) {
+        if (restart_count <= 1U) {
+            return RestartBackoff{};
+        }
+        if (backoff_policy == BackoffPolicy::Suspend) {
+            /// Restarting over and over: The conflicting writer might be descheduled.
+            if (restart_count > 16U) {
+                sched_yield();
+            }
+            return RestartBackoff{suspension(Annotation::no_height, restart_count)};
+        }
+        yield(int(restart_count));
+        return RestartBackoff{};
+    }
 
     void yield(int count) {
         if (count > 3) {
@@ -481,60 +1970,84 @@ struct BTree {
      * @return A description of inner and leaf nodes structures.
      */
     std::pair<perf::analyzer::DataType, perf::analyzer::DataType> get_node_structures() {
+        using Inner = BTreeInner<Key, PageSize>;
+
         auto inner_node = perf::analyzer::DataType{"InnerNode", PageSize};
-        inner_node.add("vptr", 8U);
         inner_node.add("latch", 8U);
-        inner_node.add("page_type", 2U);
+        inner_node.add("page_type", 1U);
+        inner_node.add("contention", 1U);
         inner_node.add("count", 2U);
-        inner_node.add("--padding--", 4U);
-        inner_node.add("keys", 112U);
-        inner_node.add("children", 112U);
-        inner_node.add("--padding--", 8U);
+        inner_node.add("height", 1U);
+        inner_node.add("appends", 1U);
+        inner_node.add("--padding--", 2U);
+        inner_node.add("next", sizeof(NodeBase *));
+        inner_node.add("high_key", sizeof(Key));
+        inner_node.add("keys", sizeof(Key) * Inner::maxEntries);
+        inner_node.add("children", sizeof(NodeBase *) * Inner::maxEntries);
+        constexpr auto inner_used_size = sizeof(NodeBase) + sizeof(Key) + (sizeof(Key) + sizeof(NodeBase *)) * Inner::maxEntries;
+        if constexpr (sizeof(Inner) > inner_used_size) {
+            inner_node.add("--padding--", sizeof(Inner) - inner_used_size);
+        }
 
         auto leaf_node = perf::analyzer::DataType{"LeafNode", PageSize};
-        leaf_node.add("vptr", 8U);
         leaf_node.add("latch", 8U);
-        leaf_node.add("page_type", 2U);
+        leaf_node.add("page_type", 1U);
+        leaf_node.add("contention", 1U);
         leaf_node.add("count", 2U);
-        leaf_node.add("--padding--", 4U);
-        leaf_node.add("keys", 112U);
-        leaf_node.add("payloads", 112U);
-        leaf_node.add("--padding--", 8U);
+        leaf_node.add("height", 1U);
+        leaf_node.add("appends", 1U);
+        leaf_node.add("--padding--", 2U);
+        leaf_node.add("next", sizeof(NodeBase *));
+        Leaf::describe(leaf_node);
 
         return std::make_pair(std::move(inner_node), std::move(leaf_node));
     }
 
     /**
-     * Traverses the tree and adds all nodes to the memory access analyzer.
-     * @param memory_access_analyzer Analyzer to add nodes to.
+     * @return Address ranges (begin, size) of all node memory: Chunks of the node allocator and the snapshot mapping.
      */
-    void traverse_tree_and_add_nodes(perf::analyzer::MemoryAccess &memory_access_analyzer) {
-        this->traverse_tree_and_add_node(memory_access_analyzer, 0U, root.load());
+    [[nodiscard]] std::vector<std::pair<const void *, std::size_t>> node_ranges() const {
+        auto ranges = std::vector<std::pair<const void *, std::size_t>>{};
+        for (const auto &[begin, size]: node_allocator.chunks()) {
+            ranges.emplace_back(begin, size);
+        }
+        if (snapshot.is_mapped()) {
+            ranges.emplace_back(snapshot.at(0U), snapshot.size());
+        }
+        return ranges;
     }
 
     /**
-     * Traverses the tree and adds all nodes.
+     * Traverses the tree (iteratively, depth-first) and adds all nodes to the memory access analyzer.
+     * Inner nodes are tagged with their level ("lvl-0" is the root).
      *
-     * @param memory_access_analyzer The access analyzer the nodes are added to.
-     * @param level The current level of the node, needed to tag inner nodes.
-     * @param node The node itself.
+     * @param memory_access_analyzer Analyzer to add nodes to.
      */
-    void traverse_tree_and_add_node(perf::analyzer::MemoryAccess &memory_access_analyzer, const std::uint8_t level, NodeBase *node) {
-        if (node->type == PageType::BTreeInner) {
-            /// Create a tag to distinct different inner node levels.
-            auto tag = std::string{"lvl-"}.append(std::to_string(level));
+    void traverse_tree_and_add_nodes(perf::analyzer::MemoryAccess &memory_access_analyzer) {
+        auto *root_node = root.load();
+
+        /// Tags of the inner node levels.
+        auto tags = std::vector<std::string>{};
+        for (auto level = 0U; level < root_node->height; ++level) {
+            tags.emplace_back(std::string{"lvl-"}.append(std::to_string(level)));
+        }
 
-            /// Add the node along with the tag.
-            memory_access_analyzer.annotate("InnerNode", node, std::move(tag));
+        auto stack = std::vector<NodeBase *>{root_node};
+        while (stack.empty() == false) {
+            auto *node = stack.back();
+            stack.pop_back();
 
-            /// Traverse child nodes.
-            auto *inner = reinterpret_cast<BTreeInner<Key, PageSize> *>(node);
-            for (auto i = 0U; i <= inner->count; ++i) {
-                this->traverse_tree_and_add_node(memory_access_analyzer, level + 1U, inner->children[i]);
+            if (node->type == PageType::BTreeInner) {
+                /// Add the node along with the tag.
+                memory_access_analyzer.annotate("InnerNode", node, std::string{tags[root_node->height - node->height]});
+
+                /// Traverse child nodes.
+                auto *inner = reinterpret_cast<BTreeInner<Key, PageSize> *>(node);
+                stack.insert(stack.end(), inner->children, inner->children + inner->count + 1U);
+            } else {
+                /// Add the node.
+                memory_access_analyzer.annotate("LeafNode", node);
             }
-        } else {
-            /// Add the node.
-            memory_access_analyzer.annotate("LeafNode", node);
         }
     }
 };
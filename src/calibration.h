@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "btree_olc.h"
+#include "machine_profile.h"
+#include "system.h"
+#include "coroutine/coroutine.h"
+
+/**
+ * Probes that measure the machine profile: Latency of dependent loads per cache level and from DRAM
+ * (pointer chases through a random cycle of cache lines), the misses the core keeps in flight (independent
+ * pointer chases, interleaved), and the cost of resuming coroutines.
+ */
+class Calibration {
+public:
+    /**
+     * Runs all probes; takes some seconds.
+     *
+     * @param dram_bytes Working set of the DRAM probes; 0 chooses four times the last-level cache (at least 256 MiB, at most 1 GiB).
+     * @return Measured profile, including the derived interleaving depth.
+     */
+    [[nodiscard]] static MachineProfile calibrate(std::uint64_t dram_bytes = 0U) {
+        auto profile = MachineProfile{};
+        profile.cpu = System::cpu_model_name();
+        profile.cache_sizes = System::data_cache_sizes();
+
+        for (const auto cache_size: profile.cache_sizes) {
+            profile.cache_latencies_ns.emplace_back(cache_size > 0U ? latency_ns(cache_size / 2U) : 0.);
+        }
+
+        if (dram_bytes == 0U) {
+            const auto last_level = profile.cache_sizes.empty() ? 0ULL : profile.cache_sizes.back();
+            dram_bytes = std::clamp<std::uint64_t>(last_level * 4U, 256ULL << 20U, 1ULL << 30U);
+        }
+        auto chain = Chain{dram_bytes};
+        profile.dram_latency_ns = chain.chase_ns(1U);
+
+        /// Little's law: Misses in flight are the latency divided by the time per miss at best.
+        auto min_ns_per_miss = profile.dram_latency_ns;
+        for (const auto count_chases: {2U, 4U, 8U, 12U, 16U, 24U, Chain::max_chases}) {
+            min_ns_per_miss = std::min(min_ns_per_miss, chain.chase_ns(count_chases) / double(count_chases));
+        }
+        profile.parallel_misses = profile.dram_latency_ns / min_ns_per_miss;
+
+        profile.coroutine_switch_ns = coroutine_switch_ns();
+        profile.coroutine_step_ns = coroutine_step_ns();
+        profile.parallel_coroutines = profile.derive_parallel_coroutines();
+
+        return profile;
+    }
+
+    /**
+     * @return Latency of a dependent load within a working set of the given size.
+     */
+    [[nodiscard]] static double latency_ns(const std::uint64_t bytes) { return Chain{bytes}.chase_ns(1U); }
+
+    /**
+     * @return Time to resume a coroutine that suspends right away.
+     */
+    [[nodiscard]] static double coroutine_switch_ns() {
+        constexpr auto count_resumes = 10000000ULL;
+
+        auto coroutine = suspend_forever();
+        const auto start_timestamp = std::chrono::steady_clock::now();
+        for (auto i = 0ULL; i < count_resumes; ++i) {
+            coroutine.resume();
+        }
+        const auto end_timestamp = std::chrono::steady_clock::now();
+        coroutine.destroy();
+
+        return std::chrono::duration<double, std::nano>(end_timestamp - start_timestamp).count() / double(count_resumes);
+    }
+
+    /**
+     * @return Time per resumption (or creation) of lookups in a tree that fits into the L1 and L2 caches,
+     *  i.e., the work of a coroutine between two prefetches when no load misses.
+     */
+    [[nodiscard]] static double coroutine_step_ns() {
+        constexpr auto count_keys = 4096ULL;
+        constexpr auto count_lookups = 2000000ULL;
+
+        auto tree = BTree<std::uint64_t, std::uint64_t>{};
+        for (auto key = 0ULL; key < count_keys; ++key) {
+            complete(tree.insert(key, key));
+        }
+
+        auto random = std::mt19937_64{1337U};
+        auto count_steps = 0ULL;
+        auto value = std::uint64_t{0U};
+        const auto start_timestamp = std::chrono::steady_clock::now();
+        for (auto i = 0ULL; i < count_lookups; ++i) {
+            auto coroutine = tree.lookup(random() % count_keys, value);
+            ++count_steps;
+            while (coroutine.is_done() == false) {
+                coroutine.resume();
+                ++count_steps;
+            }
+            coroutine.destroy();
+        }
+        const auto end_timestamp = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double, std::nano>(end_timestamp - start_timestamp).count() / double(count_steps);
+    }
+
+private:
+    /**
+     * Random cycle through the cache lines of a working set.
+     */
+    class Chain {
+    public:
+        /// Chases interleaved at most by chase_ns().
+        static constexpr std::uint32_t max_chases = 32U;
+
+        explicit Chain(const std::uint64_t bytes) : _lines(std::max<std::uint64_t>(2U, bytes / sizeof(Line))) {
+            /// Sattolo's algorithm: A random permutation with a single cycle.
+            auto order = std::vector<std::uint64_t>(_lines.size());
+            std::iota(order.begin(), order.end(), 0U);
+            auto random = std::mt19937_64{1337U};
+            for (auto i = order.size() - 1U; i > 0U; --i) {
+                std::swap(order[i], order[random() % i]);
+            }
+            for (auto i = 0ULL; i < order.size(); ++i) {
+                _lines[order[i]].next = &_lines[order[(i + 1U) % order.size()]];
+            }
+        }
+
+        /**
+         * Follows the cycle from count_chases lines (evenly spaced on the cycle) at once; the loads of
+         * different chases are independent.
+         *
+         * @return Time per step of all chases.
+         */
+        [[nodiscard]] double chase_ns(const std::uint32_t count_chases) const {
+            const auto count_steps = std::max<std::uint64_t>(1000000U, 2U * _lines.size() / count_chases);
+
+            auto cursors = std::array<const Line *, max_chases>{};
+            cursors[0U] = &_lines[0U];
+            const auto spacing = _lines.size() / count_chases;
+            for (auto chase = 1U; chase < count_chases; ++chase) {
+                cursors[chase] = cursors[chase - 1U];
+                for (auto i = 0ULL; i < spacing; ++i) {
+                    cursors[chase] = cursors[chase]->next;
+                }
+            }
+
+            /// Warm up (TLB, caches of small working sets).
+            for (auto i = 0ULL; i < std::min<std::uint64_t>(count_steps, _lines.size()); ++i) {
+                cursors[0U] = cursors[0U]->next;
+            }
+
+            const auto start_timestamp = std::chrono::steady_clock::now();
+            for (auto step = 0ULL; step < count_steps; ++step) {
+                for (auto chase = 0U; chase < count_chases; ++chase) {
+                    cursors[chase] = cursors[chase]->next;
+                }
+            }
+            const auto end_timestamp = std::chrono::steady_clock::now();
+
+            /// Keep the chases from being optimized away.
+            auto sink = std::uintptr_t{0U};
+            for (auto chase = 0U; chase < count_chases; ++chase) {
+                sink ^= std::uintptr_t(cursors[chase]);
+            }
+            asm volatile("" : : "r"(sink) : "memory");
+
+            return std::chrono::duration<double, std::nano>(end_timestamp - start_timestamp).count() / double(count_steps);
+        }
+
+    private:
+        struct alignas(64) Line {
+            const Line *next;
+        };
+
+        std::vector<Line> _lines;
+    };
+
+    static Coroutine suspend_forever() {
+        while (true) {
+            co_await Annotation{};
+        }
+    }
+
+    static void complete(Coroutine &&coroutine) {
+        while (coroutine.is_done() == false) {
+            coroutine.resume();
+        }
+        coroutine.destroy();
+    }
+};
@@ -1,21 +1,42 @@
 #pragma once
 
+#include <cassert>
 #include <coroutine>
 #include <cstdint>
 #include "coroutine_allocator.h"
 #include "prefetch_descriptor.h"
 
-thread_local CoroutineAllocator</* size of one coroutine frame*/ 256U, /* max coroutines */ 32U> coro_allocator;
+thread_local CoroutineAllocator</* size of one coroutine frame*/ 384U, /* max coroutines */ 32U> coro_allocator;
+
+/**
+ * Stage of the request when the coroutine suspends: Descending the tree to the key,
+ * or fetching a value that is stored out-of-line.
+ */
+enum class CoroutineStage : std::uint8_t {
+    KeyLookup = 0U,
+    ValueLookup = 1U,
+};
 
 class Annotation {
 public:
+    /// Height of suspensions that did not prefetch a node (e.g., before restarting).
+    static constexpr std::uint8_t no_height = 0xFFU;
+
     Annotation() noexcept = default;
 
     explicit Annotation(const std::uint16_t execution_time) noexcept: _execution_time(execution_time) {}
 
+    /**
+     * @param height Height of the node prefetched before suspending (0 for leaves), or no_height.
+     * @param count_restarts Restarts of the request so far.
+     */
+    Annotation(const std::uint8_t height, const std::uint16_t count_restarts) noexcept
+            : _height(height), _count_restarts(count_restarts) {}
+
     explicit Annotation(const PrefetchDescriptor prefetch_descriptor) noexcept: _prefetch_descriptor(
             prefetch_descriptor) {}
 
+    explicit Annotation(const CoroutineStage stage) noexcept: _stage(stage) {}
 
     ~Annotation() noexcept = default;
 
@@ -23,17 +44,44 @@ public:
 
     [[nodiscard]] PrefetchDescriptor prefetch_descriptor() const noexcept { return _prefetch_descriptor; }
 
+    [[nodiscard]] CoroutineStage stage() const noexcept { return _stage; }
+
+    [[nodiscard]] std::uint8_t height() const noexcept { return _height; }
+
+    [[nodiscard]] std::uint16_t count_restarts() const noexcept { return _count_restarts; }
+
 private:
     std::uint16_t _execution_time{0U};
+    CoroutineStage _stage{CoroutineStage::KeyLookup};
+    std::uint8_t _height{no_height};
+    std::uint16_t _count_restarts{0U};
     PrefetchDescriptor _prefetch_descriptor;
 };
 
+/**
+ * Awaited by a request before it restarts: Suspends with the annotation, unless the request backed off
+ * without suspending (e.g., by spinning) or runs its first pass.
+ */
+class RestartBackoff {
+public:
+    /// Continues right away.
+    RestartBackoff() noexcept = default;
+
+    /// Suspends with the annotation.
+    explicit RestartBackoff(const Annotation annotation) noexcept: _annotation(annotation), _is_suspend(true) {}
+
+    [[nodiscard]] Annotation annotation() const noexcept { return _annotation; }
+
+    [[nodiscard]] bool is_suspend() const noexcept { return _is_suspend; }
+
+private:
+    Annotation _annotation;
+    bool _is_suspend{false};
+};
+
 class Coroutine {
 public:
-    enum Stage : std::uint8_t {
-        KeyLookup = 0U,
-        ValueLookup = 1U,
-    };
+    using Stage = CoroutineStage;
 
     struct promise_type /// This name is forced by the standard.
     {
@@ -46,6 +94,26 @@ public:
             return {};
         }
 
+        /**
+         * Suspends only if the backoff asks for it.
+         */
+        auto await_transform(RestartBackoff &&backoff) {
+            struct Awaiter {
+                bool is_suspend;
+
+                [[nodiscard]] bool await_ready() const noexcept { return is_suspend == false; }
+
+                void await_suspend(std::coroutine_handle<>) const noexcept {}
+
+                void await_resume() const noexcept {}
+            };
+
+            if (backoff.is_suspend()) {
+                _annotation = backoff.annotation();
+            }
+            return Awaiter{backoff.is_suspend()};
+        }
+
         /// Never suspend when first time spawning a coroutine.
         std::suspend_never initial_suspend() noexcept { return {}; }
 
@@ -58,7 +126,10 @@ public:
         /// What happens if there is an unhandled exception.
         void unhandled_exception() {}
 
-        void *operator new([[maybe_unused]] const std::size_t /* size */) noexcept { return coro_allocator.allocate(); }
+        void *operator new([[maybe_unused]] const std::size_t size) noexcept {
+            assert(size <= decltype(coro_allocator)::frame_size && "Coroutine frame exceeds the allocator's frame size.");
+            return coro_allocator.allocate();
+        }
 
         void operator delete(void *pointer, [[maybe_unused]] const std::size_t /* size */) noexcept {
             coro_allocator.free(pointer);
@@ -68,6 +139,9 @@ public:
         Annotation _annotation;
     };
 
+    /**
+     * Creates a coroutine without frame, for a request that completed without suspending (e.g., a cache hit).
+     */
     Coroutine() noexcept = default;
 
     explicit Coroutine(promise_type::Handle coroutine) : _coroutine_handle(coroutine) {}
@@ -75,7 +149,12 @@ public:
     /**
      * Deallocate the frame pointer.
      */
-    void destroy() { _coroutine_handle.destroy(); }
+    void destroy() {
+        if (_coroutine_handle) {
+            _coroutine_handle.destroy();
+            _coroutine_handle = nullptr;
+        }
+    }
 
     /**
      * Continue execution.
@@ -83,9 +162,14 @@ public:
     void resume() { _coroutine_handle.resume(); }
 
     /**
-     * @return True, if the coroutine co_returned.
+     * @return True, if the coroutine co_returned (or has no frame).
+     */
+    [[nodiscard]] bool is_done() const { return !_coroutine_handle || _coroutine_handle.done(); }
+
+    /**
+     * @return True, if the request is executed by a coroutine frame.
      */
-    [[nodiscard]] bool is_done() const { return _coroutine_handle.done(); }
+    [[nodiscard]] bool has_frame() const noexcept { return static_cast<bool>(_coroutine_handle); }
 
     /**
      * @return Annotation by the application.
@@ -15,6 +15,9 @@ private:
     };
 
 public:
+    /// Size of the largest coroutine frame that can be allocated.
+    static constexpr std::size_t frame_size = SIZE;
+
     CoroutineAllocator() {
         _allocated_frames = reinterpret_cast<Frame *>(std::aligned_alloc(4096U, MAX_COROUTINES * SIZE));
         _first_free = _allocated_frames;
@@ -0,0 +1,310 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <sched.h>
+#include "coroutine_round_robin_executor.h"
+#include "mpsc_queue.h"
+
+/**
+ * Long-lived executor that accepts single requests from any thread. A worker thread interleaves the
+ * submitted requests as coroutines (like the CoroutineRoundRobinExecutor) and completes them through
+ * futures, callbacks, or (without allocating) requests owned by the submitter. Requests are queued in a
+ * lock-free, intrusive MPSC queue; the worker sleeps while idle. If the write-ahead log of the tree fails
+ * to commit, the active requests and all requests submitted afterward fail instead of completing.
+ *
+ * @tparam T Type of the tree.
+ */
+template<typename T>
+class CoroutineAsyncExecutor {
+public:
+    using value_type = typename T::value_type;
+
+    /// Called on the worker thread with the request and the result (the found value of lookups).
+    using Callback = std::function<void(const NumericTuple &, const value_type &)>;
+
+    /**
+     * Starts the worker thread.
+     *
+     * @param tree Tree to execute requests on; only the worker accesses the tree.
+     * @param parallel_coroutines Number of requests interleaved at most (default: the machine profile's depth).
+     * @param core Core the worker is pinned to (not pinned if negative).
+     */
+    explicit CoroutineAsyncExecutor(T &tree,
+                                    const std::uint16_t parallel_coroutines = MachineProfile::current().parallel_coroutines,
+                                    const std::int32_t core = -1)
+            : _tree(tree), _parallel_coroutines(parallel_coroutines) {
+        assert(parallel_coroutines > 0U && parallel_coroutines <= 32U && "Coroutine allocator holds 32 frames.");
+        _worker = std::thread{[this] { this->work(); }};
+        if (core >= 0) {
+            auto cpu_set = cpu_set_t{};
+            CPU_ZERO(&cpu_set);
+            CPU_SET(core, &cpu_set);
+            ::pthread_setaffinity_np(_worker.native_handle(), sizeof(cpu_set_t), &cpu_set);
+        }
+    }
+
+    CoroutineAsyncExecutor(const CoroutineAsyncExecutor &) = delete;
+
+    CoroutineAsyncExecutor &operator=(const CoroutineAsyncExecutor &) = delete;
+
+    /**
+     * Completes all submitted requests and stops the worker.
+     */
+    ~CoroutineAsyncExecutor() {
+        _is_running.store(false);
+        _count_submitted.fetch_add(1U);
+        _count_submitted.notify_one();
+        _worker.join();
+    }
+
+    /**
+     * Request owned by the submitter and linked into the queue without allocating; it must stay alive
+     * (and must not be submitted again) until it completed. Derived requests override complete() to act
+     * on the result on the worker thread.
+     */
+    class Request : public MpscQueueNode {
+    public:
+        Request() noexcept = default;
+
+        explicit Request(const NumericTuple &tuple_) noexcept: tuple(tuple_) {}
+
+        virtual ~Request() = default;
+
+        NumericTuple tuple{NumericTuple::Type::LOOKUP, 0U};
+
+        /// Result; for lookups the found value (default-constructed if the key is missing).
+        value_type value{};
+
+        /**
+         * @return True, once the worker completed the request; the submitter may reuse it afterward.
+         */
+        [[nodiscard]] bool is_completed() const noexcept { return _is_completed.load(std::memory_order_acquire); }
+
+        /**
+         * Waits (yielding the thread) until the worker completed the request.
+         */
+        void wait() const noexcept {
+            while (is_completed() == false) {
+                std::this_thread::yield();
+            }
+        }
+
+        /**
+         * Called on the worker thread once the request completed; overrides must call it last,
+         * since the submitter may release the request afterward.
+         */
+        virtual void complete() { _is_completed.store(true, std::memory_order_release); }
+
+        /**
+         * Called on the worker thread instead of complete() if the request is not supported by the tree or
+         * its modifications could not be logged; overrides must call it last, like complete().
+         *
+         * @param error Failure of the write-ahead log.
+         */
+        virtual void fail(std::exception_ptr error) {
+            _error = std::move(error);
+            _is_completed.store(true, std::memory_order_release);
+        }
+
+        /**
+         * @return Failure of the request (once completed), or null if the request succeeded.
+         */
+        [[nodiscard]] std::exception_ptr error() const noexcept { return _error; }
+
+    private:
+        friend class CoroutineAsyncExecutor;
+
+        std::atomic<bool> _is_completed{false};
+        std::exception_ptr _error;
+    };
+
+    /**
+     * Submits the request without allocating; thread-safe.
+     *
+     * @param request Request; owned by the caller until it completed.
+     */
+    void submit(Request &request) {
+        request._is_completed.store(false, std::memory_order_relaxed);
+        request._error = nullptr;
+        enqueue(&request);
+    }
+
+    /**
+     * Submits the request; thread-safe. Allocates the request (and the shared state of the future).
+     *
+     * @param request Request.
+     * @return Future holding the result; for lookups the found value (default-constructed if the key is missing).
+     */
+    std::future<value_type> submit(const NumericTuple &request) {
+        auto *pending = new PendingRequest{request};
+        auto future = pending->promise.get_future();
+        enqueue(pending);
+        return future;
+    }
+
+    /**
+     * Submits the request; thread-safe. Allocates the request.
+     *
+     * @param request Request.
+     * @param callback Callback invoked on the worker thread once the request completed (not if it failed).
+     */
+    void submit(const NumericTuple &request, Callback &&callback) {
+        auto *pending = new PendingRequest{request};
+        pending->callback = std::move(callback);
+        enqueue(pending);
+    }
+
+    /**
+     * @return Number of completed requests.
+     */
+    [[nodiscard]] std::uint64_t count_completed() const noexcept { return _count_completed.load(); }
+
+private:
+    /**
+     * A request submitted by value, completed through a future or callback.
+     */
+    struct PendingRequest final : public Request {
+        explicit PendingRequest(const NumericTuple &request) : Request(request) {}
+
+        std::promise<value_type> promise;
+        Callback callback;
+
+        void complete() override {
+            if (callback) {
+                callback(this->tuple, this->value);
+            } else {
+                promise.set_value(this->value);
+            }
+            delete this;
+        }
+
+        void fail(std::exception_ptr error) override {
+            if (!callback) {
+                promise.set_exception(std::move(error));
+            }
+            delete this;
+        }
+    };
+
+    /**
+     * Coroutine that executes a request.
+     */
+    struct ActiveRequest {
+        Request *request{nullptr};
+        Coroutine coroutine;
+    };
+
+    T &_tree;
+
+    const std::uint16_t _parallel_coroutines;
+
+    MpscQueue _queue;
+
+    /// Incremented after each submit; the idle worker waits for a change.
+    alignas(64) std::atomic<std::uint64_t> _count_submitted{0U};
+
+    alignas(64) std::atomic<std::uint64_t> _count_completed{0U};
+
+    std::atomic<bool> _is_running{true};
+
+    /// Failure of the write-ahead log; requests are failed once it is set (only accessed by the worker).
+    std::exception_ptr _error;
+
+    std::thread _worker;
+
+    void enqueue(Request *request) {
+        assert(_is_running.load() && "Submitted to a stopped executor.");
+        _queue.push(request);
+        _count_submitted.fetch_add(1U);
+        _count_submitted.notify_one();
+    }
+
+    /**
+     * Loop of the worker: Fill free slots with submitted requests, resume all active coroutines
+     * once per round, and complete the finished requests.
+     */
+    void work() {
+        auto active_requests = std::vector<ActiveRequest>{};
+        active_requests.reserve(_parallel_coroutines);
+
+        while (true) {
+            /// Read the counter before polling the queue, so that a request submitted in between wakes the worker.
+            const auto count_submitted = _count_submitted.load();
+
+            while (active_requests.size() < _parallel_coroutines) {
+                auto *request = static_cast<Request *>(_queue.pop());
+                if (request == nullptr) {
+                    break;
+                }
+                if (_error != nullptr) {
+                    request->fail(_error);
+                    continue;
+                }
+                try {
+                    active_requests.push_back(ActiveRequest{
+                            request, CoroutineRoundRobinExecutor::spawn(_tree, request->tuple, request->value)});
+                } catch (const std::invalid_argument &) {
+                    /// Unsupported request (e.g., ADD on non-numeric values).
+                    request->fail(std::current_exception());
+                }
+            }
+
+            if (active_requests.empty()) {
+                if (_is_running.load() == false) {
+                    break;
+                }
+                _count_submitted.wait(count_submitted);
+                continue;
+            }
+
+            for (auto &active_request: active_requests) {
+                if (!active_request.coroutine.is_done()) {
+                    active_request.coroutine.resume();
+                }
+            }
+
+            /// Group commit: Requests are completed only after their modifications are durable.
+            if (_tree.write_ahead_log != nullptr) {
+                try {
+                    _tree.write_ahead_log->commit();
+                } catch (...) {
+                    /// The modifications of this round are not durable: Fail all active requests.
+                    _error = std::current_exception();
+                    for (auto &active_request: active_requests) {
+                        active_request.coroutine.destroy();
+                        active_request.request->fail(_error);
+                    }
+                    active_requests.clear();
+                    continue;
+                }
+            }
+
+            /// Complete finished requests and free their slots.
+            for (auto i = 0U; i < active_requests.size();) {
+                auto &active_request = active_requests[i];
+                if (active_request.coroutine.is_done()) {
+                    active_request.coroutine.destroy();
+                    complete(active_request.request);
+                    active_request = active_requests.back();
+                    active_requests.pop_back();
+                } else {
+                    ++i;
+                }
+            }
+        }
+    }
+
+    void complete(Request *request) {
+        request->complete();
+        _count_completed.fetch_add(1U, std::memory_order_relaxed);
+    }
+};
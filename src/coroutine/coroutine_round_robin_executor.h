@@ -1,68 +1,571 @@
 #pragma once
 
 #include <btree_olc.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "coroutine_trace.h"
+#include "machine_profile.h"
 #include "workload/workload_set.h"
 
 class CoroutineRoundRobinExecutor {
 public:
-    template<typename K, typename V>
-    static void execute(BTree<K, V> &tree, const std::vector<NumericTuple> &workload) {
-        /// Number of coroutines executed in parallel.
-        const auto parallel_coroutines = std::min<std::uint64_t>(12U, workload.size());
+    /**
+     * Executes all requests of the workload, interleaving as many coroutines as the machine profile
+     * suggests (by default; 12 without a profile, see MachineProfile).
+     *
+     * @param tree Tree to execute the workload on.
+     * @param workload Requests.
+     * @param count_completed Optional counter of completed requests, updated once per round (e.g., for a CounterTimeline).
+     * @param count_coroutines Number of coroutines executed in parallel (interleaving depth), at most 32.
+     */
+    template<typename T>
+    static void execute(T &tree, const std::vector<NumericTuple> &workload,
+                        std::atomic<std::uint64_t> *count_completed = nullptr,
+                        const std::uint64_t count_coroutines = parallel_coroutines()) {
+        using V = typename T::value_type;
 
         /// Space for lookup values.
         auto values = std::vector<V>{};
         values.resize(workload.size());
 
+        run(tree, workload.size(), [&](const std::uint64_t index) {
+            return spawn(tree, workload[index], values[index]);
+        }, count_completed, count_coroutines);
+    }
+
+    /**
+     * Executes all requests like execute() and calls the callback whenever the executor observes a request
+     * completed, i.e., after its last resumption (or right away for requests completed without suspending).
+     * The time between creating a request's coroutine and the callback is the request's latency.
+     *
+     * @param tree Tree to execute the workload on.
+     * @param workload Requests.
+     * @param on_spawn Callable invoked with the index of a request before its coroutine is created.
+     * @param on_completed Callable invoked with the index of a completed request.
+     * @param count_coroutines Number of coroutines executed in parallel (interleaving depth), at most 32.
+     */
+    template<typename T, typename S, typename C>
+    static void execute_observed(T &tree, const std::vector<NumericTuple> &workload, S &&on_spawn, C &&on_completed,
+                                 const std::uint64_t count_coroutines = parallel_coroutines()) {
+        using V = typename T::value_type;
+
+        /// Space for lookup values.
+        auto values = std::vector<V>{};
+        values.resize(workload.size());
+
+        run(tree, workload.size(), [&](const std::uint64_t index) {
+            on_spawn(index);
+            return spawn(tree, workload[index], values[index]);
+        }, nullptr, count_coroutines, on_completed);
+    }
+
+    /**
+     * Executes all requests like execute() and records the scheduling events of every coroutine slot
+     * (creation, resumptions, suspensions with the height of the prefetched node, restarts, and completion)
+     * into the ring of the calling thread, see CoroutineTrace.
+     *
+     * @param tree Tree to execute the workload on.
+     * @param workload Requests.
+     * @param trace Trace the events are recorded into.
+     * @param count_coroutines Number of coroutines executed in parallel (interleaving depth), at most 32.
+     */
+    template<typename T>
+    static void execute_traced(T &tree, const std::vector<NumericTuple> &workload, CoroutineTrace &trace,
+                               const std::uint64_t count_coroutines = parallel_coroutines()) {
+        using V = typename T::value_type;
+
+        /// Space for lookup values.
+        auto values = std::vector<V>{};
+        values.resize(workload.size());
+
+        run(tree, workload.size(), [&](const std::uint64_t index) {
+            return spawn(tree, workload[index], values[index]);
+        }, nullptr, count_coroutines, IgnoreCompletion{}, &trace);
+    }
+
+    /**
+     * Executes all requests like execute(), but orders the coroutines by the annotation of their last
+     * suspension: A coroutine that suspended before restarting is skipped for longer with every restart and
+     * takes its turn again once it backed off, so it is never starved. If more coroutines are interleaved
+     * than a prefetch takes steps to land, a coroutine overtakes the one ahead of it if it has less work
+     * left (its execution time hint, or the height of the node it continues with); with fewer, every
+     * coroutine needs the full round for its prefetch to land. Requests are started in workload order.
+     *
+     * Time is counted in resumptions rather than read from a clock (which costs as much as a resumption on
+     * some machines): A prefetch lands after as many resumptions of other coroutines as the DRAM latency
+     * of the machine profile takes steps of a coroutine.
+     *
+     * @param tree Tree to execute the workload on.
+     * @param workload Requests.
+     * @param count_completed Optional counter of completed requests, updated once per round.
+     * @param count_coroutines Number of coroutines executed in parallel (interleaving depth), at most 32.
+     */
+    template<typename T>
+    static void execute_scheduled(T &tree, const std::vector<NumericTuple> &workload,
+                                  std::atomic<std::uint64_t> *count_completed = nullptr,
+                                  const std::uint64_t count_coroutines = parallel_coroutines()) {
+        using V = typename T::value_type;
+
+        /// Space for lookup values.
+        auto values = std::vector<V>{};
+        values.resize(workload.size());
+
+        run_scheduled(tree, workload.size(), [&](const std::uint64_t index) {
+            return spawn(tree, workload[index], values[index]);
+        }, count_completed, count_coroutines);
+    }
+
+    /**
+     * Executes the workload like execute(), but batches inserts: The inserts (and updates) of every window
+     * are sorted by key and split into one contiguous slice per coroutine; each slice descends the tree
+     * once per leaf instead of once per key. Other requests are executed one by one. Inserts of the same
+     * key keep their order; other requests of a window are not ordered with respect to its inserts.
+     *
+     * @param tree Tree to execute the workload on.
+     * @param workload Requests.
+     * @param window_size Number of requests that are batched together.
+     */
+    template<typename T>
+    static void execute_batched(T &tree, const std::vector<NumericTuple> &workload,
+                                const std::uint64_t window_size = 4096U) {
+        using K = typename T::key_type;
+        using V = typename T::value_type;
+
+        /// Space for lookup values.
+        auto values = std::vector<V>{};
+        values.resize(workload.size());
+
+        /// Sorted inserts of all windows; tasks point into this vector, so it is never re-allocated.
+        auto inserts = std::vector<std::pair<K, V>>{};
+        inserts.reserve(workload.size());
+
+        auto tasks = std::vector<BatchedTask>{};
+        for (auto window_begin = 0ULL; window_begin < workload.size(); window_begin += window_size) {
+            const auto window_end = std::min<std::uint64_t>(window_begin + window_size, workload.size());
+
+            const auto inserts_begin = inserts.size();
+            for (auto index = window_begin; index < window_end; ++index) {
+                const auto &request = workload[index];
+                if (request == NumericTuple::Type::INSERT || request == NumericTuple::Type::UPDATE) {
+                    inserts.emplace_back(request.key(), request.value());
+                } else {
+                    tasks.push_back(BatchedTask{false, index, index + 1U});
+                }
+            }
+            std::stable_sort(inserts.begin() + inserts_begin, inserts.end(),
+                             [](const auto &left, const auto &right) { return left.first < right.first; });
+
+            /// One slice of the window per coroutine; equal keys stay in the same slice to keep their order.
+            const auto count_inserts = inserts.size() - inserts_begin;
+            const auto count_slices = parallel_coroutines();
+            const auto slice_size = std::max<std::uint64_t>(1U, (count_inserts + count_slices - 1U) / count_slices);
+            for (auto slice_begin = inserts_begin; slice_begin < inserts.size();) {
+                auto slice_end = std::min<std::uint64_t>(slice_begin + slice_size, inserts.size());
+                while (slice_end < inserts.size() && inserts[slice_end].first == inserts[slice_end - 1U].first) {
+                    ++slice_end;
+                }
+                tasks.push_back(BatchedTask{true, slice_begin, slice_end});
+                slice_begin = slice_end;
+            }
+        }
+
+        run(tree, tasks.size(), [&](const std::uint64_t index) {
+            const auto &task = tasks[index];
+            if (task.is_insert_batch) {
+                return tree.insert_batch(inserts.data() + task.begin, inserts.data() + task.end);
+            }
+
+            return spawn(tree, workload[task.begin], values[task.begin]);
+        });
+    }
+
+    /**
+     * Creates the coroutine that executes the given request. Throws std::invalid_argument for ADD and
+     * COMPARE_AND_SET on trees with non-numeric values, instead of executing them as lookups.
+     *
+     * @param tree Tree to execute the request on.
+     * @param request Request.
+     * @param value Space for the result of lookups.
+     * @return The coroutine, executed until the first suspension.
+     */
+    template<typename T>
+    static Coroutine spawn(T &tree, const NumericTuple &request, typename T::value_type &value) {
+        /// Lookups of hot keys are answered by the cache (if any) without creating a coroutine.
+        if (request == NumericTuple::Type::LOOKUP && tree.lookup_cached(request.key(), value)) {
+            return Coroutine{};
+        }
+
+        if (request == NumericTuple::Type::INSERT || request == NumericTuple::Type::UPDATE) {
+            return tree.insert(request.key(), request.value());
+        }
+
+        if (request == NumericTuple::Type::DELETE) {
+            return tree.remove(request.key());
+        }
+
+        if (request == NumericTuple::Type::SCAN) {
+            return tree.scan(request.key(), std::uint64_t(request.value()), value);
+        }
+
+        if (request == NumericTuple::Type::INSERT_IF_ABSENT) {
+            return tree.insert_if_absent(request.key(), request.value(), value);
+        }
+
+        /// Arithmetic on values needs in-line (numeric) values.
+        using V = typename T::value_type;
+        if constexpr (std::is_arithmetic_v<V>) {
+            if (request == NumericTuple::Type::ADD) {
+                return tree.add(request.key(), V(request.value()), value);
+            }
+
+            if (request == NumericTuple::Type::COMPARE_AND_SET) {
+                return tree.compare_and_set(request.key(), V(request.expected()), V(request.desired()), value);
+            }
+        } else if (request == NumericTuple::Type::ADD || request == NumericTuple::Type::COMPARE_AND_SET) {
+            throw std::invalid_argument{"ADD and COMPARE_AND_SET need numeric values."};
+        }
+
+        return tree.lookup(request.key(), value);
+    }
+
+private:
+    /**
+     * @return Number of coroutines executed in parallel by default; 12 without a machine profile.
+     */
+    static std::uint64_t parallel_coroutines() { return MachineProfile::current().parallel_coroutines; }
+
+    /**
+     * Default for run(): Completed tasks are not observed.
+     */
+    struct IgnoreCompletion {
+        void operator()(std::uint64_t) const noexcept {}
+    };
+
+    /**
+     * Either a slice of sorted inserts or a single (other) request of the workload.
+     */
+    struct BatchedTask {
+        bool is_insert_batch;
+
+        /// Index of the first insert of the slice, or of the request.
+        std::uint64_t begin;
+
+        /// Index behind the last insert of the slice.
+        std::uint64_t end;
+    };
+
+
+    /**
+     * @return True, if the coroutine suspended before restarting; completed coroutines did not restart.
+     */
+    [[nodiscard]] static bool is_restart(const Annotation annotation) noexcept {
+        return (annotation.height() == Annotation::no_height) & (annotation.count_restarts() > 0U);
+    }
+
+    /**
+     * @return Work left by the annotation: The execution time, if given, otherwise the height of the node
+     *  prefetched; values fetched out-of-line are the last step.
+     */
+    [[nodiscard]] static std::uint16_t remaining_work(const Annotation annotation) noexcept {
+        const auto height = std::uint16_t(annotation.height() == Annotation::no_height ? 0U : annotation.height());
+        return annotation.execution_time() > 0U ? annotation.execution_time() : height;
+    }
+
+    /**
+     * Interleaves the tasks like run(), but schedules the coroutines by their annotations, see
+     * execute_scheduled(): Coroutines are visited in rounds, like run(), which keeps picking the next
+     * coroutine free of scans and branches on the coroutine resumed last. Before a coroutine is resumed,
+     * the one after next may overtake the next one, and coroutines backing off are skipped. With a
+     * write-ahead log, completed coroutines are replaced only in the round after their commit.
+     *
+     * @param tree Tree the tasks are executed on.
+     * @param count_tasks Number of tasks.
+     * @param spawn_task Callable that creates the coroutine executing the task with the given index.
+     * @param count_completed Optional counter of completed tasks.
+     * @param max_coroutines Number of coroutines executed in parallel.
+     */
+    template<typename T, typename F>
+    static void run_scheduled(T &tree, const std::uint64_t count_tasks, F &&spawn_task,
+                              std::atomic<std::uint64_t> *count_completed, const std::uint64_t max_coroutines) {
+        assert(max_coroutines > 0U && max_coroutines <= 32U && "Coroutine allocator holds 32 frames.");
+
+        /// Without a calibrated profile, a prefetch lands after a round of the default depth.
+        const auto &profile = MachineProfile::current();
+        const auto latency_steps = profile.dram_latency_ns > 0. && profile.coroutine_step_ns > 0.
+                                   ? std::max<std::uint64_t>(1U, std::uint64_t(profile.dram_latency_ns /
+                                                                                profile.coroutine_step_ns + .5))
+                                   : std::uint64_t(MachineProfile::default_parallel_coroutines - 1U);
+
+        /// Coroutines in the order they are visited; a coroutine that overtakes swaps places.
+        const auto count_coroutines = std::uint32_t(std::min<std::uint64_t>(max_coroutines, count_tasks));
+        auto coroutines = std::vector<Coroutine>(count_coroutines);
+        auto request_index = 0ULL;
+
+        /// Creates the coroutine of the next task; requests completed without a frame (cache hits) are replaced
+        /// right away. Returns the number of those requests.
+        const auto spawn_pending = [&spawn_task, &request_index, &coroutines, count_tasks](Coroutine &coroutine) {
+            auto count_completed_without_frame = 0U;
+            coroutine.destroy();
+            coroutine = destroy_on_failure(coroutines, [&] { return spawn_task(request_index++); });
+            while (coroutine.has_frame() == false && request_index < count_tasks) {
+                ++count_completed_without_frame;
+                coroutine = destroy_on_failure(coroutines, [&] { return spawn_task(request_index++); });
+            }
+            return count_completed_without_frame;
+        };
+
+        /// Requests completed without a frame may use up the tasks before every coroutine got one; the others
+        /// stay without a frame, i.e., completed.
+        auto count_replaced = 0U;
+        auto count_spawned_coroutines = 0U;
+        for (; count_spawned_coroutines < count_coroutines && request_index < count_tasks;
+               ++count_spawned_coroutines) {
+            count_replaced += spawn_pending(coroutines[count_spawned_coroutines]);
+        }
+
+        /// Coroutines overtake only if more are interleaved than a prefetch takes resumptions to land; otherwise,
+        /// no two coroutines are ready at once.
+        const auto is_overtaking = count_coroutines > latency_steps + 1U;
+
+        /// Coroutines (by place) that suspended before restarting, and the visit every one backed off at.
+        auto backing_off = std::uint32_t{0U};
+        auto backed_off_at = std::array<std::uint64_t, 32U>{};
+
+        /// Work left of the coroutines (by place), read from the annotation when they suspended.
+        auto remaining_works = std::array<std::uint16_t, 32U>{};
+        for (auto place = 0U; place < count_spawned_coroutines; ++place) {
+            if (coroutines[place].has_frame()) {
+                remaining_works[place] = remaining_work(coroutines[place].annotation());
+            }
+        }
+
+        /// Number of visits so far.
+        auto now = 0ULL;
+
+        auto count_finished_coroutines = 0U;
+        do {
+            count_finished_coroutines = 0U;
+            for (auto place = 0U; place < count_coroutines; ++place, ++now) {
+                auto &coroutine = coroutines[place];
+                if (coroutine.is_done()) {
+                    /// Completed in an earlier round, i.e., its modifications are committed.
+                    if (request_index < count_tasks) {
+                        count_replaced += 1U + spawn_pending(coroutine);
+                        if (coroutine.has_frame()) {
+                            remaining_works[place] = remaining_work(coroutine.annotation());
+                        }
+                    } else {
+                        ++count_finished_coroutines;
+                    }
+                    continue;
+                }
+
+                if (backing_off != 0U && (backing_off & (1U << place)) != 0U) {
+                    if (backed_off_at[place] > now) {
+                        continue;
+                    }
+                    backing_off &= ~(1U << place);
+                }
+
+                /// The next coroutine overtakes the one behind it if it has less work left and neither backs off;
+                /// decided one visit ahead (so that the next coroutine does not wait for the decision) and without
+                /// a branch (since the decision is hard to predict). Only coroutines not visited in this round
+                /// swap places.
+                if (is_overtaking && place + 2U < count_coroutines) {
+                    const auto is_overtaken = (remaining_works[place + 2U] < remaining_works[place + 1U]) &
+                                              (((backing_off >> (place + 1U)) & 3U) == 0U);
+                    const auto first = coroutines[place + 1U];
+                    const auto second = coroutines[place + 2U];
+                    const auto first_work = remaining_works[place + 1U];
+                    const auto second_work = remaining_works[place + 2U];
+                    coroutines[place + 1U] = is_overtaken ? second : first;
+                    coroutines[place + 2U] = is_overtaken ? first : second;
+                    remaining_works[place + 1U] = is_overtaken ? second_work : first_work;
+                    remaining_works[place + 2U] = is_overtaken ? first_work : second_work;
+                }
+
+                coroutine.resume();
+                const auto annotation = coroutine.annotation();
+                remaining_works[place] = remaining_work(annotation);
+                if (is_restart(annotation)) {
+                    /// The conflicting writer needs time, the more the longer it takes.
+                    backing_off |= 1U << place;
+                    backed_off_at[place] = now + latency_steps * std::min<std::uint64_t>(annotation.count_restarts(), 16U);
+                }
+            }
+
+            /// Group commit: Modifications of all coroutines in this round are logged with a single write.
+            commit(tree, coroutines);
+
+            if (count_completed != nullptr && count_replaced > 0U) {
+                count_completed->fetch_add(count_replaced, std::memory_order_relaxed);
+            }
+            count_replaced = 0U;
+        } while (count_finished_coroutines < count_coroutines);
+
+        /// The last task of every coroutine is completed.
+        if (count_completed != nullptr && count_spawned_coroutines > 0U) {
+            count_completed->fetch_add(count_spawned_coroutines, std::memory_order_relaxed);
+        }
+
+        for (auto &coroutine : coroutines) {
+            coroutine.destroy();
+        }
+    }
+
+    /**
+     * Calls the callable; if it throws (e.g., spawning an unsupported request or committing the log failed),
+     * all coroutines are destroyed (returning their frames to the thread-local allocator) before the failure
+     * is passed on to the caller.
+     */
+    template<typename F>
+    static decltype(auto) destroy_on_failure(std::vector<Coroutine> &coroutines, F &&callable) {
+        try {
+            return callable();
+        } catch (...) {
+            for (auto &coroutine : coroutines) {
+                coroutine.destroy();
+            }
+            throw;
+        }
+    }
+
+    /**
+     * Commits the modifications of the last round to the write-ahead log of the tree (if any), see
+     * destroy_on_failure().
+     */
+    template<typename T>
+    static void commit(T &tree, std::vector<Coroutine> &coroutines) {
+        if (tree.write_ahead_log != nullptr) {
+            destroy_on_failure(coroutines, [&tree] { tree.write_ahead_log->commit(); });
+        }
+    }
+
+    /**
+     * Records the suspension (or completion) of the coroutine after it was created or resumed.
+     */
+    static void record_suspension(CoroutineTrace::Ring &ring, const std::uint32_t slot, const std::uint64_t task,
+                                  const Coroutine &coroutine) {
+        if (coroutine.is_done()) {
+            ring.record(CoroutineTrace::EventType::Complete, slot, task,
+                        coroutine.has_frame() ? coroutine.annotation() : Annotation{});
+        } else {
+            ring.record(CoroutineTrace::EventType::Suspend, slot, task, coroutine.annotation());
+        }
+    }
+
+    /**
+     * Interleaves the given number of tasks, each executed by a coroutine, in round-robin fashion.
+     *
+     * @param tree Tree the tasks are executed on.
+     * @param count_tasks Number of tasks.
+     * @param spawn_task Callable that creates the coroutine executing the task with the given index.
+     * @param count_completed Optional counter of completed tasks.
+     * @param max_coroutines Number of coroutines executed in parallel.
+     * @param on_completed Callable invoked with the index of every completed task.
+     * @param trace Optional trace of the scheduling events.
+     */
+    template<typename T, typename F, typename C = IgnoreCompletion>
+    static void run(T &tree, const std::uint64_t count_tasks, F &&spawn_task,
+                    std::atomic<std::uint64_t> *count_completed = nullptr,
+                    const std::uint64_t max_coroutines = parallel_coroutines(), C &&on_completed = C{},
+                    CoroutineTrace *trace = nullptr) {
+        assert(max_coroutines > 0U && max_coroutines <= 32U && "Coroutine allocator holds 32 frames.");
+
+        /// Events of this thread; the ring is looked up once.
+        auto *ring = trace != nullptr ? &trace->ring() : nullptr;
+        const auto spawn_traced = [&](const std::uint32_t slot, const std::uint64_t index) {
+            if (ring == nullptr) {
+                return spawn_task(index);
+            }
+            ring->record(CoroutineTrace::EventType::Spawn, slot, index);
+            auto coroutine = spawn_task(index);
+            record_suspension(*ring, slot, index, coroutine);
+            return coroutine;
+        };
+
+        /// Number of coroutines executed in parallel.
+        const auto count_coroutines = std::min<std::uint64_t>(max_coroutines, count_tasks);
+
         /// Coroutines that await execution.
         auto active_coroutine_frames = std::vector<Coroutine>{};
 
+        /// Index of the task executed by every coroutine.
+        auto active_tasks = std::vector<std::uint64_t>{};
+
         auto request_index = 0ULL;
 
         /// Store the first coroutines within the active frame.
-        for (auto i = 0U; i < parallel_coroutines; ++i) {
-            const auto index = request_index++;
-            const auto &request = workload[index];
-            if (request == NumericTuple::Type::INSERT || request == NumericTuple::Type::UPDATE) {
-                active_coroutine_frames.push_back(tree.insert(request.key(), request.value()));
-            } else if (request == NumericTuple::Type::LOOKUP) {
-                active_coroutine_frames.push_back(tree.lookup(request.key(), values[index]));
-            }
+        for (auto i = 0U; i < count_coroutines; ++i) {
+            active_tasks.push_back(request_index);
+            active_coroutine_frames.push_back(
+                    destroy_on_failure(active_coroutine_frames, [&] { return spawn_traced(i, request_index++); }));
         }
 
         /// Dispatch coroutines until all requests are done AND all coroutines finished.
         std::uint32_t count_finished_coroutine_frames;
         do {
             count_finished_coroutine_frames = 0U;
-            for (auto i = 0U; i < parallel_coroutines; ++i) {
+            auto count_replaced_coroutine_frames = 0U;
+            for (auto i = 0U; i < count_coroutines; ++i) {
                 /// Resume this coroutine as it has not entirely executed the request.
                 if (!active_coroutine_frames[i].is_done()) {
-                    active_coroutine_frames[i].resume();
+                    if (ring == nullptr) {
+                        active_coroutine_frames[i].resume();
+                    } else {
+                        ring->record(CoroutineTrace::EventType::Resume, i, active_tasks[i]);
+                        active_coroutine_frames[i].resume();
+                        record_suspension(*ring, i, active_tasks[i], active_coroutine_frames[i]);
+                    }
                 }
 
                     /// The coroutine has completed the request. Replace by a new one, if there are pending requests.
                 else {
-                    const auto is_pending_requests = request_index < workload.size();
+                    const auto is_pending_requests = request_index < count_tasks;
                     if (is_pending_requests) {
-                        /// Free the coro frame.
-                        active_coroutine_frames[i].destroy();
-
-                        /// If the coroutine was finished, create a new one for the next request---if any.
-                        const auto index = request_index++;
-                        const auto &request = workload[index];
-                        if (request == NumericTuple::Type::INSERT || request == NumericTuple::Type::UPDATE) {
-                            active_coroutine_frames[i] =
-                                    tree.insert(request.key(), request.value());
-                        } else if (request == NumericTuple::Type::LOOKUP) {
-                            active_coroutine_frames[i] =
-                                    tree.lookup(request.key(), values[index]);
-                        }
+                        /// Requests completed without a coroutine frame (cache hits) are replaced right away.
+                        do {
+                            /// Free the coro frame.
+                            on_completed(active_tasks[i]);
+                            active_coroutine_frames[i].destroy();
+
+                            /// If the coroutine was finished, create a new one for the next request---if any.
+                            active_tasks[i] = request_index;
+                            active_coroutine_frames[i] = destroy_on_failure(
+                                    active_coroutine_frames, [&] { return spawn_traced(i, request_index++); });
+                            ++count_replaced_coroutine_frames;
+                        } while (active_coroutine_frames[i].has_frame() == false && request_index < count_tasks);
                     } else /// Otherwise, only wait to finish the last requests.
                     {
                         ++count_finished_coroutine_frames;
                     }
                 }
             }
-        } while (count_finished_coroutine_frames < parallel_coroutines);
+
+            /// Group commit: Modifications of all coroutines in this round are logged with a single write.
+            /// A finished coroutine is replaced only in the next round, i.e., after its modification is durable.
+            commit(tree, active_coroutine_frames);
+
+            if (count_completed != nullptr && count_replaced_coroutine_frames > 0U) {
+                count_completed->fetch_add(count_replaced_coroutine_frames, std::memory_order_relaxed);
+            }
+        } while (count_finished_coroutine_frames < count_coroutines);
+
+        /// The last tasks are completed.
+        if (count_completed != nullptr) {
+            count_completed->fetch_add(count_coroutines, std::memory_order_relaxed);
+        }
+
+        /// Return the frames of the last requests to the (thread-local) coroutine allocator.
+        for (auto i = 0U; i < count_coroutines; ++i) {
+            on_completed(active_tasks[i]);
+            active_coroutine_frames[i].destroy();
+        }
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "coroutine.h"
+#ifdef __x86_64__
+#include <x86intrin.h>
+#endif
+
+/**
+ * Scheduling events of the coroutines of executor threads, recorded into one ring buffer per thread
+ * (the newest events overwrite the oldest once the ring is full) and written as Chrome trace JSON,
+ * which chrome://tracing and ui.perfetto.dev display without further tools.
+ *
+ * Every thread shows one track per executor slot: A slice for every resumption (named by the node the
+ * coroutine continues with, i.e., the height it prefetched before suspending), gaps while the coroutine
+ * waits for its prefetch, instant events for restarts, and one slice per request from creation to completion.
+ */
+class CoroutineTrace {
+public:
+    enum class EventType : std::uint8_t {
+        /// The coroutine of a request is created (and runs until the first suspension).
+        Spawn = 0U,
+        Resume = 1U,
+        Suspend = 2U,
+        Complete = 3U,
+    };
+
+    struct Event {
+        std::uint64_t timestamp;
+
+        /// Index of the request (or task) within the workload.
+        std::uint64_t task;
+
+        EventType type;
+        std::uint8_t slot;
+
+        /// Annotation of suspensions: Height of the prefetched node, stage, and restarts so far.
+        std::uint8_t height;
+        CoroutineStage stage;
+        std::uint16_t count_restarts;
+    };
+
+    /**
+     * Events of one executor thread; written by this thread only.
+     */
+    class Ring {
+    public:
+        explicit Ring(const std::uint64_t capacity) : _events(capacity) {}
+
+        void record(const EventType type, const std::uint8_t slot, const std::uint64_t task,
+                    const Annotation annotation = Annotation{}) noexcept {
+            _events[_count_events++ % _events.size()] = Event{now(), task, type, slot, annotation.height(),
+                                                              annotation.stage(), annotation.count_restarts()};
+        }
+
+        /**
+         * @return Recorded events that were not overwritten, oldest first.
+         */
+        [[nodiscard]] std::vector<Event> events() const {
+            auto events = std::vector<Event>{};
+            const auto count = std::min<std::uint64_t>(_count_events, _events.size());
+            for (auto i = _count_events - count; i < _count_events; ++i) {
+                events.push_back(_events[i % _events.size()]);
+            }
+            return events;
+        }
+
+    private:
+        std::vector<Event> _events;
+        std::uint64_t _count_events{0U};
+    };
+
+    /**
+     * @param capacity Events kept per thread (24 bytes each).
+     */
+    explicit CoroutineTrace(const std::uint64_t capacity = 1ULL << 20U)
+            : _capacity(std::max<std::uint64_t>(1U, capacity)), _start_ticks(now()),
+              _start_timestamp(std::chrono::steady_clock::now()) {}
+
+    ~CoroutineTrace() = default;
+
+    /**
+     * @return The ring of the calling thread, created on first use; thread-safe.
+     */
+    Ring &ring() {
+        auto lock = std::lock_guard{_mutex};
+        const auto thread_id = std::this_thread::get_id();
+        for (auto &[id, ring]: _rings) {
+            if (id == thread_id) {
+                return *ring;
+            }
+        }
+        return *_rings.emplace_back(thread_id, std::make_unique<Ring>(_capacity)).second;
+    }
+
+    /**
+     * Writes the events of all threads as Chrome trace JSON; no thread may record meanwhile.
+     *
+     * @return True, if the file was written.
+     */
+    bool write_chrome_trace(const std::string &file_name) const {
+        auto out_stream = std::ofstream{file_name, std::ios::trunc};
+        if (out_stream.is_open() == false) {
+            return false;
+        }
+
+        /// Ticks are converted to microseconds (as expected by the format) by the ticks elapsed since creation.
+        const auto elapsed_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() -
+                                                                          _start_timestamp).count();
+        const auto us_per_tick = elapsed_us / double(std::max<std::uint64_t>(1U, now() - _start_ticks));
+        const auto to_us = [&](const std::uint64_t ticks) { return double(ticks - _start_ticks) * us_per_tick; };
+
+        auto is_first = true;
+        const auto separator = [&]() -> const char * {
+            const auto *separator = is_first ? "\n" : ",\n";
+            is_first = false;
+            return separator;
+        };
+
+        out_stream << std::fixed << std::setprecision(3) << "{\"traceEvents\": [";
+        auto lock = std::lock_guard{_mutex};
+        for (auto thread = 0U; thread < _rings.size(); ++thread) {
+            out_stream << separator() << R"({"ph": "M", "name": "process_name", "pid": )" << thread
+                       << R"(, "args": {"name": "executor thread )" << thread << "\"}}";
+
+            /// Open slices (resumption and request) per slot.
+            struct Slot {
+                bool is_named{false};
+                bool is_running{false};
+                bool is_spawning{false};
+                bool is_request{false};
+                std::uint64_t begin{0U};
+
+                /// Last suspension of the request executed by the slot.
+                Event suspension{};
+            };
+            auto slots = std::vector<Slot>(256U);
+
+            for (const auto &event: _rings[thread].second->events()) {
+                auto &slot = slots[event.slot];
+                const auto prefix = [&](const char *phase, const std::uint64_t timestamp) -> std::ostream & {
+                    return out_stream << separator() << R"({"ph": ")" << phase << R"(", "pid": )" << thread
+                                      << R"(, "tid": )" << std::uint32_t(event.slot) << R"(, "ts": )"
+                                      << to_us(timestamp);
+                };
+
+                if (slot.is_named == false) {
+                    out_stream << separator() << R"({"ph": "M", "name": "thread_name", "pid": )" << thread
+                               << R"(, "tid": )" << std::uint32_t(event.slot) << R"(, "args": {"name": "slot )"
+                               << std::uint32_t(event.slot) << "\"}}";
+                    slot.is_named = true;
+                }
+
+                if (event.type == EventType::Spawn) {
+                    prefix("b", event.timestamp) << R"(, "cat": "request", "name": "request", "id": )" << event.task
+                                                 << "}";
+                    slot = Slot{true, true, true, true, event.timestamp, event};
+                    continue;
+                }
+
+                if (event.type == EventType::Resume) {
+                    slot.is_running = true;
+                    slot.is_spawning = false;
+                    slot.begin = event.timestamp;
+                    continue;
+                }
+
+                /// Suspend or Complete: Closes the resumption, unless its begin was overwritten.
+                if (slot.is_running) {
+                    prefix("X", slot.begin) << R"(, "dur": )" << to_us(event.timestamp) - to_us(slot.begin)
+                                            << R"(, "name": ")" << name(slot.is_spawning, slot.suspension)
+                                            << R"(", "args": {"task": )" << event.task << "}}";
+                }
+                if (slot.suspension.task == event.task && event.count_restarts > slot.suspension.count_restarts) {
+                    prefix("i", event.timestamp) << R"(, "s": "t", "name": "restart", "args": {"task": )" << event.task
+                                                 << R"(, "restarts": )" << event.count_restarts << "}}";
+                }
+                if (event.type == EventType::Complete && slot.is_request) {
+                    prefix("e", event.timestamp) << R"(, "cat": "request", "name": "request", "id": )" << event.task
+                                                 << "}";
+                    slot.is_request = false;
+                }
+                slot.is_running = false;
+                if (event.type == EventType::Suspend) {
+                    slot.suspension = event;
+                }
+            }
+        }
+        out_stream << "\n]}\n";
+
+        return out_stream.good();
+    }
+
+    /**
+     * @return Timestamp in ticks (TSC on x86, nanoseconds otherwise).
+     */
+    [[nodiscard]] static std::uint64_t now() noexcept {
+#ifdef __x86_64__
+        return __rdtsc();
+#else
+        return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+private:
+    const std::uint64_t _capacity;
+    const std::uint64_t _start_ticks;
+    const std::chrono::steady_clock::time_point _start_timestamp;
+
+    mutable std::mutex _mutex;
+    std::vector<std::pair<std::thread::id, std::unique_ptr<Ring>>> _rings;
+
+    /**
+     * @return Name of a resumption, after the suspension it continues from.
+     */
+    [[nodiscard]] static std::string name(const bool is_spawn, const Event &suspension) {
+        if (is_spawn) {
+            return "spawn";
+        }
+        if (suspension.stage == CoroutineStage::ValueLookup) {
+            return "value";
+        }
+        if (suspension.height == Annotation::no_height) {
+            return "restart";
+        }
+        return suspension.height == 0U ? std::string{"leaf"}
+                                       : std::string{"height "}.append(std::to_string(suspension.height));
+    }
+};
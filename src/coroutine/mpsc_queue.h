@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+
+/**
+ * Link of an element in the MpscQueue; elements derive from it.
+ */
+struct MpscQueueNode {
+    std::atomic<MpscQueueNode *> next{nullptr};
+};
+
+/**
+ * Intrusive, unbounded, lock-free queue with many producers and a single consumer (D. Vyukov).
+ * Producers push with a single exchange; the consumer pops without atomic read-modify-writes.
+ * The queue does not own its elements.
+ */
+class MpscQueue {
+public:
+    MpscQueue() noexcept = default;
+
+    MpscQueue(const MpscQueue &) = delete;
+
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    ~MpscQueue() noexcept = default;
+
+    /**
+     * Appends the node; may be called from any thread.
+     *
+     * @param node Node to append.
+     */
+    void push(MpscQueueNode *node) noexcept {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        auto *previous = _head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    /**
+     * Removes the first node; must only be called by the consumer.
+     * A node whose producer was interrupted between exchange and link is not visible yet.
+     *
+     * @return The first node, or nullptr if the queue is (observed) empty.
+     */
+    MpscQueueNode *pop() noexcept {
+        auto *tail = _tail;
+        auto *next = tail->next.load(std::memory_order_acquire);
+        if (tail == &_stub) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            _tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr) {
+            _tail = next;
+            return tail;
+        }
+
+        /// The tail is the last node: Re-insert the stub to detach it, unless a producer is appending.
+        if (tail != _head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        push(&_stub);
+
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            _tail = next;
+            return tail;
+        }
+
+        return nullptr;
+    }
+
+private:
+    /// Placeholder that keeps the queue non-empty.
+    MpscQueueNode _stub;
+
+    /// Last pushed node (written by producers).
+    alignas(64) std::atomic<MpscQueueNode *> _head{&_stub};
+
+    /// Next node to pop (only accessed by the consumer).
+    alignas(64) MpscQueueNode *_tail{&_stub};
+};
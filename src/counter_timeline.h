@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <thread>
+#include <vector>
+#include "perf_event_counters.h"
+
+/**
+ * Counters of one interval of a CounterTimeline.
+ */
+struct CounterSnapshot {
+    /// End of the interval, since the timeline started.
+    double seconds;
+
+    /// Requests completed since the timeline started.
+    std::uint64_t count_requests;
+
+    /// Events within the interval.
+    std::uint64_t interval_requests;
+    double interval_seconds;
+    double instructions;
+    double cycles;
+    double llc_misses;
+    double branch_misses;
+
+    [[nodiscard]] double throughput() const noexcept {
+        return interval_seconds > 0. ? double(interval_requests) / interval_seconds : 0.;
+    }
+
+    [[nodiscard]] double ipc() const noexcept { return cycles > 0. ? instructions / cycles : 0.; }
+
+    [[nodiscard]] double per_request(const double events) const noexcept {
+        return interval_requests > 0U ? events / double(interval_requests) : 0.;
+    }
+};
+
+/**
+ * Records instructions, cycles, LLC misses, branch misses, and completed requests of the calling thread
+ * (and threads it starts) as a time series. A background thread takes a snapshot every interval,
+ * or whenever the given number of requests completed. The executor reports completed requests
+ * through count_completed(), e.g., CoroutineRoundRobinExecutor::execute(tree, workload, &timeline.count_completed()).
+ */
+class CounterTimeline {
+public:
+    /**
+     * Snapshots every interval.
+     *
+     * @param interval Time between two snapshots.
+     */
+    explicit CounterTimeline(const std::chrono::milliseconds interval) : _interval(interval) {}
+
+    /**
+     * Snapshots whenever the given number of requests completed (detected within 100us).
+     *
+     * @param requests_per_snapshot Number of requests between two snapshots.
+     */
+    explicit CounterTimeline(const std::uint64_t requests_per_snapshot)
+            : _interval(0U), _requests_per_snapshot(requests_per_snapshot) {}
+
+    CounterTimeline(const CounterTimeline &) = delete;
+
+    CounterTimeline &operator=(const CounterTimeline &) = delete;
+
+    ~CounterTimeline() { stop(); }
+
+    /**
+     * @return Counter of completed requests, to be updated by the executor.
+     */
+    [[nodiscard]] std::atomic<std::uint64_t> &count_completed() noexcept { return _count_completed; }
+
+    /**
+     * Starts the counters (for the calling thread) and the snapshot thread.
+     */
+    void start() {
+        _snapshots.clear();
+        _count_completed.store(0U);
+        _perf_event.startCounters();
+        _start = std::chrono::steady_clock::now();
+        _is_running.store(true);
+        _snapshot_thread = std::thread{[this] { this->take_snapshots(); }};
+    }
+
+    /**
+     * Stops the snapshot thread, taking a last snapshot, and the counters.
+     */
+    void stop() {
+        if (_snapshot_thread.joinable()) {
+            _is_running.store(false);
+            _snapshot_thread.join();
+            _perf_event.stopCounters();
+        }
+    }
+
+    [[nodiscard]] const std::vector<CounterSnapshot> &snapshots() const noexcept { return _snapshots; }
+
+    /**
+     * Writes the time series as CSV, one line per snapshot.
+     */
+    void write_csv(std::ostream &stream) const {
+        stream << "seconds,requests,throughput,ipc,llc-misses/op,branch-misses/op\n";
+        for (const auto &snapshot: _snapshots) {
+            stream << snapshot.seconds << "," << snapshot.count_requests << "," << snapshot.throughput() << ","
+                   << snapshot.ipc() << "," << snapshot.per_request(snapshot.llc_misses) << ","
+                   << snapshot.per_request(snapshot.branch_misses) << "\n";
+        }
+        stream << std::flush;
+    }
+
+private:
+    const std::chrono::milliseconds _interval;
+    const std::uint64_t _requests_per_snapshot{0U};
+
+    /// Counters (including instructions, cycles, LLC misses, branch misses) opened for the constructing thread.
+    PerfEvent _perf_event;
+
+    alignas(64) std::atomic<std::uint64_t> _count_completed{0U};
+
+    std::atomic<bool> _is_running{false};
+
+    std::chrono::steady_clock::time_point _start;
+
+    std::thread _snapshot_thread;
+
+    std::vector<CounterSnapshot> _snapshots;
+
+    void take_snapshots() {
+        auto last = CounterSnapshot{};
+        auto next_requests = _requests_per_snapshot;
+        auto next_time = _start + _interval;
+
+        while (true) {
+            const auto is_running = _is_running.load();
+            if (is_running) {
+                /// Wait for the next interval or number of requests.
+                if (_requests_per_snapshot > 0U) {
+                    if (_count_completed.load(std::memory_order_relaxed) < next_requests) {
+                        std::this_thread::sleep_for(std::chrono::microseconds{100U});
+                        continue;
+                    }
+                    next_requests += _requests_per_snapshot;
+                } else {
+                    if (std::chrono::steady_clock::now() < next_time) {
+                        std::this_thread::sleep_for(std::min(std::chrono::duration_cast<std::chrono::microseconds>(
+                                next_time - std::chrono::steady_clock::now()), std::chrono::microseconds{1000U}));
+                        continue;
+                    }
+                    next_time += _interval;
+                }
+            }
+
+            auto snapshot = CounterSnapshot{};
+            snapshot.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count();
+            snapshot.count_requests = _count_completed.load(std::memory_order_relaxed);
+            snapshot.interval_requests = snapshot.count_requests - last.count_requests;
+            snapshot.interval_seconds = snapshot.seconds - last.seconds;
+
+            /// Counters hold totals since start; the snapshot holds the difference to the previous one.
+            PerfEventCounters::read(_perf_event);
+            const auto instructions = std::max(0., _perf_event.getCounter("instructions"));
+            const auto cycles = std::max(0., _perf_event.getCounter("cycles"));
+            const auto llc_misses = std::max(0., _perf_event.getCounter("LLC-misses"));
+            const auto branch_misses = std::max(0., _perf_event.getCounter("branch-misses"));
+            snapshot.instructions = instructions - last.instructions;
+            snapshot.cycles = cycles - last.cycles;
+            snapshot.llc_misses = llc_misses - last.llc_misses;
+            snapshot.branch_misses = branch_misses - last.branch_misses;
+            /// The last snapshot (when stopping) is kept only if requests completed since the previous one.
+            if (snapshot.interval_seconds > 0. && (is_running || snapshot.interval_requests > 0U)) {
+                _snapshots.push_back(snapshot);
+            }
+
+            /// Keep the totals to compute the next interval.
+            last = snapshot;
+            last.instructions = instructions;
+            last.cycles = cycles;
+            last.llc_misses = llc_misses;
+            last.branch_misses = branch_misses;
+
+            if (is_running == false) {
+                break;
+            }
+        }
+    }
+};
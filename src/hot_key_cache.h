@@ -0,0 +1,277 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+/**
+ * Small, set-associative cache of the values of frequently looked up keys, placed in front of the tree.
+ * A hit answers a lookup without descending the tree (and without creating a coroutine).
+ *
+ * Admission (TinyLFU): Misses are counted in a small frequency sketch; a key is admitted only if it was
+ * missed more often than the victim, so that one-hit wonders do not evict hot keys.
+ * Eviction (CLOCK): Hits set a reference bit; the victim is the first entry of the set without the bit,
+ * starting at a way chosen by the admitted key (instead of a shared clock hand).
+ *
+ * Slots are protected by sequence locks: Readers never write the slot (except for setting the reference bit
+ * once), writers lock a single slot. The tree keeps the cache consistent: Writers update or invalidate
+ * the key while holding the leaf lock, and lookups validate the leaf version after admitting a key.
+ *
+ * @tparam Key Type of the keys.
+ * @tparam Value Type of the values.
+ */
+template<class Key, class Value>
+class HotKeyCache {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>);
+
+public:
+    /**
+     * @param capacity Number of cached keys (rounded up to a multiple of the associativity and a power of two).
+     */
+    explicit HotKeyCache(const std::uint64_t capacity = 4096U)
+            : _count_sets(std::bit_ceil(std::max<std::uint64_t>(capacity / ways, 1U))),
+              _sets(new Set[_count_sets]),
+              _count_counters(_count_sets * ways * counters_per_entry),
+              _sketch(new std::atomic<std::uint8_t>[_count_counters]{}) {}
+
+    HotKeyCache(const HotKeyCache &) = delete;
+
+    HotKeyCache &operator=(const HotKeyCache &) = delete;
+
+    ~HotKeyCache() = default;
+
+    /**
+     * Looks up the key; counts a miss in the frequency sketch.
+     *
+     * @param key Key to look up.
+     * @param value Value of the key, if cached.
+     * @return True, if the key was cached.
+     */
+    bool lookup(const Key key, Value &value) {
+        const auto hash = this->hash(key);
+        auto &set = _sets[hash & (_count_sets - 1U)];
+        for (auto &slot: set.slots) {
+            const auto version = slot.version.load(std::memory_order_acquire);
+            if ((version & 1U) || slot.is_valid.load(std::memory_order_relaxed) == false ||
+                slot.key.load(std::memory_order_relaxed) != key) {
+                continue;
+            }
+            const auto cached_value = slot.value.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) != version) {
+                continue;
+            }
+
+            if (slot.is_referenced.load(std::memory_order_relaxed) == false) {
+                slot.is_referenced.store(true, std::memory_order_relaxed);
+            }
+            value = cached_value;
+            _count_hits.store(_count_hits.load(std::memory_order_relaxed) + 1U, std::memory_order_relaxed);
+            return true;
+        }
+
+        count_miss(hash);
+        return false;
+    }
+
+    /**
+     * Caches the value of a key that was looked up in the tree, if the key is more frequent than the victim.
+     * The caller has to validate that the value did not change meanwhile (and invalidate otherwise).
+     *
+     * @param key Key that was looked up.
+     * @param value Value of the key.
+     */
+    void admit(const Key key, const Value value) {
+        const auto hash = this->hash(key);
+        const auto frequency = estimate(hash);
+        if (frequency < min_admission_frequency) {
+            return;
+        }
+
+        auto &set = _sets[hash & (_count_sets - 1U)];
+
+        /// Choose a free slot or the first slot without reference bit (second chance for the others).
+        auto *victim = static_cast<Slot *>(nullptr);
+        const auto first_way = hash >> 62U;
+        for (auto round = 0U; round < 2U && victim == nullptr; ++round) {
+            for (auto way = 0U; way < ways; ++way) {
+                auto &slot = set.slots[(first_way + way) % ways];
+                if (slot.is_valid.load(std::memory_order_relaxed) == false) {
+                    victim = &slot;
+                    break;
+                }
+                if (slot.key.load(std::memory_order_relaxed) == key) {
+                    return; /// Admitted concurrently.
+                }
+                if (slot.is_referenced.load(std::memory_order_relaxed)) {
+                    slot.is_referenced.store(false, std::memory_order_relaxed);
+                } else {
+                    victim = &slot;
+                    break;
+                }
+            }
+        }
+        if (victim == nullptr) {
+            return; /// All entries were referenced again meanwhile.
+        }
+
+        /// TinyLFU: Keep the victim if it is at least as frequent as the candidate.
+        if (victim->is_valid.load(std::memory_order_relaxed) &&
+            estimate(this->hash(victim->key.load(std::memory_order_relaxed))) >= frequency) {
+            return;
+        }
+
+        /// Another writer holds the slot: Skip admission.
+        auto version = victim->version.load(std::memory_order_relaxed);
+        if ((version & 1U) || victim->version.compare_exchange_strong(version, version + 1U,
+                                                                      std::memory_order_acquire) == false) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        victim->key.store(key, std::memory_order_relaxed);
+        victim->value.store(value, std::memory_order_relaxed);
+        victim->is_valid.store(true, std::memory_order_relaxed);
+        victim->is_referenced.store(false, std::memory_order_relaxed);
+        victim->version.store(version + 2U, std::memory_order_release);
+    }
+
+    /**
+     * Replaces the value of the key, if cached; called by writers while holding the leaf lock.
+     */
+    void update(const Key key, const Value value) {
+        for_each_slot(key, [&](Slot &slot) { slot.value.store(value, std::memory_order_relaxed); });
+    }
+
+    /**
+     * Removes the key, if cached; called by writers while holding the leaf lock.
+     */
+    void invalidate(const Key key) {
+        for_each_slot(key, [](Slot &slot) { slot.is_valid.store(false, std::memory_order_relaxed); });
+    }
+
+    /**
+     * @return Number of lookups answered by the cache (approximate if used by multiple threads).
+     */
+    [[nodiscard]] std::uint64_t count_hits() const noexcept { return _count_hits.load(std::memory_order_relaxed); }
+
+    /**
+     * @return Number of lookups not answered by the cache (approximate if used by multiple threads).
+     */
+    [[nodiscard]] std::uint64_t count_misses() const noexcept {
+        return _count_misses.load(std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] std::uint64_t capacity() const noexcept { return _count_sets * ways; }
+
+private:
+    /// Entries per set.
+    static constexpr std::uint64_t ways = 4U;
+
+    /// Counters of the frequency sketch per cached entry.
+    static constexpr std::uint64_t counters_per_entry = 4U;
+
+    /// Keys missed less often are not admitted.
+    static constexpr std::uint8_t min_admission_frequency = 2U;
+
+    struct Slot {
+        /// Sequence lock: Odd while a writer modifies the slot.
+        std::atomic<std::uint64_t> version{0U};
+        std::atomic<Key> key{};
+        std::atomic<Value> value{};
+        std::atomic<bool> is_valid{false};
+        std::atomic<bool> is_referenced{false};
+    };
+
+    struct alignas(64) Set {
+        std::array<Slot, ways> slots;
+    };
+
+    const std::uint64_t _count_sets;
+    std::unique_ptr<Set[]> _sets;
+
+    /// Count-min sketch (two counters per key) of misses, halved periodically to forget old frequencies.
+    const std::uint64_t _count_counters;
+    std::unique_ptr<std::atomic<std::uint8_t>[]> _sketch;
+
+    alignas(64) std::atomic<std::uint64_t> _count_misses{0U};
+    alignas(64) std::atomic<std::uint64_t> _count_hits{0U};
+
+    /**
+     * @return Hash of the key (murmur3 finalizer); the set is selected by the low bits, the sketch counters
+     *  and the first way by higher bits.
+     */
+    [[nodiscard]] static std::uint64_t hash(const Key key) noexcept {
+        auto hash = std::uint64_t(std::hash<Key>{}(key));
+        hash ^= hash >> 33U;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33U;
+        hash *= 0xC4CEB9FE1A85EC53ULL;
+        hash ^= hash >> 33U;
+        return hash;
+    }
+
+    [[nodiscard]] std::uint64_t counter(const std::uint64_t hash, const std::uint32_t index) const noexcept {
+        return (index == 0U ? hash >> 20U : hash >> 40U) & (_count_counters - 1U);
+    }
+
+    [[nodiscard]] std::uint8_t estimate(const std::uint64_t hash) const noexcept {
+        return std::min(_sketch[counter(hash, 0U)].load(std::memory_order_relaxed),
+                        _sketch[counter(hash, 1U)].load(std::memory_order_relaxed));
+    }
+
+    void count_miss(const std::uint64_t hash) {
+        for (auto index = 0U; index < 2U; ++index) {
+            auto &counter = _sketch[this->counter(hash, index)];
+            const auto frequency = counter.load(std::memory_order_relaxed);
+            if (frequency < 15U) {
+                counter.store(frequency + 1U, std::memory_order_relaxed);
+            }
+        }
+
+        /// Age the sketch after as many misses as it has counters.
+        const auto count_misses = _count_misses.load(std::memory_order_relaxed) + 1U;
+        _count_misses.store(count_misses, std::memory_order_relaxed);
+        if (count_misses % _count_counters == 0U) {
+            for (auto i = 0ULL; i < _count_counters; ++i) {
+                _sketch[i].store(_sketch[i].load(std::memory_order_relaxed) / 2U, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Calls the function for every (valid) slot holding the key, with the slot locked.
+     */
+    template<typename F>
+    void for_each_slot(const Key key, F &&function) {
+        auto &set = _sets[hash(key) & (_count_sets - 1U)];
+        for (auto &slot: set.slots) {
+            if (slot.is_valid.load(std::memory_order_relaxed) == false ||
+                slot.key.load(std::memory_order_relaxed) != key) {
+                continue;
+            }
+
+            /// Lock the slot; concurrent writers only hold it for a few stores.
+            auto version = slot.version.load(std::memory_order_relaxed);
+            while ((version & 1U) || slot.version.compare_exchange_weak(version, version + 1U,
+                                                                        std::memory_order_acquire) == false) {
+#ifdef __x86_64__
+                _mm_pause();
+#endif
+                version = slot.version.load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            if (slot.is_valid.load(std::memory_order_relaxed) && slot.key.load(std::memory_order_relaxed) == key) {
+                function(slot);
+            }
+            slot.version.store(version + 2U, std::memory_order_release);
+        }
+    }
+};
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include "open_addressing_hash_table.h"
+#include "workload/workload_set.h"
+
+/**
+ * Latencies of a sample of the requests of one workload: Every sample_rate-th request is timed,
+ * to keep the overhead of reading the clock small (and equal for all backends).
+ */
+class RequestLatencies {
+public:
+    explicit RequestLatencies(const std::uint64_t count_requests, const std::uint64_t sample_rate = 16U)
+            : _sample_rate(sample_rate), _starts((count_requests + sample_rate - 1U) / sample_rate),
+              _latencies(_starts.size()) {}
+
+    ~RequestLatencies() = default;
+
+    void begin(const std::uint64_t index) {
+        if (index % _sample_rate == 0U) {
+            _starts[index / _sample_rate] = std::chrono::steady_clock::now();
+        }
+    }
+
+    void end(const std::uint64_t index) {
+        if (index % _sample_rate == 0U) {
+            _latencies[index / _sample_rate] = std::chrono::steady_clock::now() - _starts[index / _sample_rate];
+        }
+    }
+
+    /**
+     * @param p Percentile in [0, 1].
+     * @return Latency of the given percentile of the sampled requests.
+     */
+    [[nodiscard]] std::chrono::nanoseconds percentile(const double p) {
+        if (_latencies.empty()) {
+            return std::chrono::nanoseconds{0U};
+        }
+        if (_is_sorted == false) {
+            std::sort(_latencies.begin(), _latencies.end());
+            _is_sorted = true;
+        }
+        return _latencies[std::min<std::uint64_t>(_latencies.size() - 1U, std::uint64_t(double(_latencies.size()) * p))];
+    }
+
+private:
+    const std::uint64_t _sample_rate;
+    std::vector<std::chrono::steady_clock::time_point> _starts;
+    std::vector<std::chrono::nanoseconds> _latencies;
+    bool _is_sorted{false};
+};
+
+/**
+ * Index that executes workloads of numeric requests; lets the same workload and timing code
+ * run against the tree and baseline data structures.
+ */
+class IndexBackend {
+public:
+    virtual ~IndexBackend() = default;
+
+    [[nodiscard]] virtual std::string name() const = 0;
+
+    /**
+     * Executes all requests of the workload (on the calling thread).
+     *
+     * @param workload Requests.
+     * @param latencies Latencies of the requests.
+     */
+    virtual void execute(const std::vector<NumericTuple> &workload, RequestLatencies &latencies) = 0;
+
+    /**
+     * @return Bytes of memory allocated by the index (approximate for node-based containers).
+     */
+    [[nodiscard]] virtual std::uint64_t allocated_bytes() const = 0;
+};
+
+/**
+ * The tree, interleaving the requests by coroutines.
+ */
+class CoroutineTreeBackend final : public IndexBackend {
+public:
+    CoroutineTreeBackend() = default;
+
+    ~CoroutineTreeBackend() override = default;
+
+    [[nodiscard]] std::string name() const override { return "btree-coroutines"; }
+
+    void execute(const std::vector<NumericTuple> &workload, RequestLatencies &latencies) override {
+        CoroutineRoundRobinExecutor::execute_observed(
+                _tree, workload, [&latencies](const std::uint64_t index) { latencies.begin(index); },
+                [&latencies](const std::uint64_t index) { latencies.end(index); });
+    }
+
+    [[nodiscard]] std::uint64_t allocated_bytes() const override { return _tree.node_allocator.allocated_bytes(); }
+
+private:
+    BTree<std::uint64_t, std::uint64_t> _tree;
+};
+
+/**
+ * The same tree without interleaving: Every request is resumed until it completes before the next one starts,
+ * i.e., the descent is synchronous (the prefetches of the tree are still issued).
+ */
+class SynchronousTreeBackend final : public IndexBackend {
+public:
+    SynchronousTreeBackend() = default;
+
+    ~SynchronousTreeBackend() override = default;
+
+    [[nodiscard]] std::string name() const override { return "btree-synchronous"; }
+
+    void execute(const std::vector<NumericTuple> &workload, RequestLatencies &latencies) override {
+        auto value = std::uint64_t{0U};
+        for (auto index = 0ULL; index < workload.size(); ++index) {
+            latencies.begin(index);
+            auto coroutine = CoroutineRoundRobinExecutor::spawn(_tree, workload[index], value);
+            while (coroutine.is_done() == false) {
+                coroutine.resume();
+            }
+            coroutine.destroy();
+            latencies.end(index);
+        }
+    }
+
+    [[nodiscard]] std::uint64_t allocated_bytes() const override { return _tree.node_allocator.allocated_bytes(); }
+
+private:
+    BTree<std::uint64_t, std::uint64_t> _tree;
+};
+
+/**
+ * Red-black tree of the standard library.
+ */
+class StdMapBackend final : public IndexBackend {
+public:
+    StdMapBackend() = default;
+
+    ~StdMapBackend() override = default;
+
+    [[nodiscard]] std::string name() const override { return "std::map"; }
+
+    void execute(const std::vector<NumericTuple> &workload, RequestLatencies &latencies) override {
+        auto value = std::uint64_t{0U};
+        for (auto index = 0ULL; index < workload.size(); ++index) {
+            const auto &request = workload[index];
+            latencies.begin(index);
+            if (request == NumericTuple::Type::INSERT || request == NumericTuple::Type::UPDATE) {
+                _map.insert_or_assign(request.key(), std::uint64_t(request.value()));
+            } else if (request == NumericTuple::Type::DELETE) {
+                _map.erase(request.key());
+            } else if (request == NumericTuple::Type::ADD) {
+                value = (_map[request.key()] += std::uint64_t(request.value()));
+            } else if (request == NumericTuple::Type::COMPARE_AND_SET) {
+                if (const auto iterator = _map.find(request.key()); iterator != _map.end()) {
+                    value = iterator->second;
+                    if (iterator->second == request.expected()) {
+                        iterator->second = request.desired();
+                    }
+                }
+            } else if (request == NumericTuple::Type::INSERT_IF_ABSENT) {
+                value = _map.try_emplace(request.key(), std::uint64_t(request.value())).first->second;
+            } else if (request == NumericTuple::Type::SCAN) {
+                auto iterator = _map.lower_bound(request.key());
+                for (auto i = 0LL; i < request.value() && iterator != _map.end(); ++i, ++iterator) {
+                    value = iterator->second;
+                }
+            } else if (const auto iterator = _map.find(request.key()); iterator != _map.end()) {
+                value = iterator->second;
+            }
+            latencies.end(index);
+        }
+        _sink = value;
+    }
+
+    /**
+     * Every entry is a node with three pointers and a color besides the entry (allocator overhead not included).
+     */
+    [[nodiscard]] std::uint64_t allocated_bytes() const override {
+        return _map.size() * (sizeof(std::uint64_t) * 2U + sizeof(void *) * 4U);
+    }
+
+private:
+    std::map<std::uint64_t, std::uint64_t> _map;
+
+    /// Keeps the compiler from dropping lookups.
+    volatile std::uint64_t _sink{0U};
+};
+
+/**
+ * Open-addressing hash table; scans are not supported and executed as lookups of their first key.
+ */
+class HashTableBackend final : public IndexBackend {
+public:
+    HashTableBackend() = default;
+
+    ~HashTableBackend() override = default;
+
+    [[nodiscard]] std::string name() const override { return "hash-table"; }
+
+    void execute(const std::vector<NumericTuple> &workload, RequestLatencies &latencies) override {
+        auto value = std::uint64_t{0U};
+        for (auto index = 0ULL; index < workload.size(); ++index) {
+            const auto &request = workload[index];
+            latencies.begin(index);
+            if (request == NumericTuple::Type::INSERT || request == NumericTuple::Type::UPDATE) {
+                _table.insert(request.key(), std::uint64_t(request.value()));
+            } else if (request == NumericTuple::Type::DELETE) {
+                _table.remove(request.key());
+            } else if (request == NumericTuple::Type::ADD) {
+                value = 0U;
+                _table.lookup(request.key(), value);
+                value += std::uint64_t(request.value());
+                _table.insert(request.key(), value);
+            } else if (request == NumericTuple::Type::COMPARE_AND_SET) {
+                if (_table.lookup(request.key(), value) && value == request.expected()) {
+                    _table.insert(request.key(), std::uint64_t(request.desired()));
+                }
+            } else if (request == NumericTuple::Type::INSERT_IF_ABSENT) {
+                if (_table.lookup(request.key(), value) == false) {
+                    value = std::uint64_t(request.value());
+                    _table.insert(request.key(), value);
+                }
+            } else {
+                _table.lookup(request.key(), value);
+            }
+            latencies.end(index);
+        }
+        _sink = value;
+    }
+
+    [[nodiscard]] std::uint64_t allocated_bytes() const override { return _table.allocated_bytes(); }
+
+private:
+    OpenAddressingHashTable<std::uint64_t, std::uint64_t> _table;
+
+    /// Keeps the compiler from dropping lookups.
+    volatile std::uint64_t _sink{0U};
+};
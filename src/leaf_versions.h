@@ -0,0 +1,245 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <set>
+#include <vector>
+#include "open_addressing_hash_table.h"
+
+/**
+ * Point-in-time view of the tree, see LeafVersions::open().
+ */
+struct ReadView {
+    /// Writes that preserved an image with this (or a larger) timestamp are not visible to the view.
+    std::uint64_t timestamp{0U};
+};
+
+/**
+ * Copy-on-write images of leaves for read views (multi-versioning). While a view is open, the first write
+ * to a leaf after the view was opened copies the leaf into an image tagged with the current timestamp;
+ * images of a leaf form a chain from newest to oldest. A view reads the oldest image that is at least as
+ * new as the view, or the leaf itself if no write preserved an image since the view was opened.
+ * A split passes the chain of the leaf on to the new leaf, whose keys are found in the images of the split one.
+ *
+ * Chains are kept aside of the leaves (keyed by leaf), so that leaves are unchanged and writers only read
+ * two atomics while no view is open. Chains and images are sharded by leaf, so writers preserving different
+ * leaves rarely share a lock. Images no view can read anymore (and the chains of their leaves) are freed
+ * when a view is closed.
+ *
+ * @tparam Leaf Type of the leaves.
+ */
+template<class Leaf>
+class LeafVersions {
+public:
+    /**
+     * Image of a leaf; immutable once linked.
+     */
+    struct Version {
+        /// Timestamp when the image was taken; the image is read by views with a timestamp not above.
+        std::uint64_t timestamp;
+
+        /// Next older image; only followed if its timestamp is not below the view (i.e., it is not freed yet).
+        Version *next;
+        std::uint64_t next_timestamp;
+
+        Leaf image;
+    };
+
+    LeafVersions() = default;
+
+    LeafVersions(const LeafVersions &) = delete;
+
+    LeafVersions &operator=(const LeafVersions &) = delete;
+
+    ~LeafVersions() {
+        for (auto &shard: _shards) {
+            for (auto *version: shard.versions) {
+                delete version;
+            }
+        }
+    }
+
+    /**
+     * Opens a view of the current state of the tree; has to be closed by close().
+     */
+    ReadView open() {
+        /// Writers read the timestamp before the number of views: A writer that does not see this view
+        /// read the timestamp before it was incremented, i.e., the write is visible to the view.
+        _count_views.fetch_add(1U);
+        auto lock = std::lock_guard{_views_mutex};
+        const auto view = ReadView{_timestamp.fetch_add(1U) + 1U};
+        _views.insert(view.timestamp);
+        return view;
+    }
+
+    /**
+     * Closes the view and frees the images no open view can read anymore.
+     */
+    void close(const ReadView view) {
+        {
+            auto lock = std::lock_guard{_views_mutex};
+            _views.erase(_views.find(view.timestamp));
+        }
+        _count_views.fetch_sub(1U);
+        collect();
+    }
+
+    /**
+     * Preserves the leaf for open views before it is modified; called by writers holding the leaf lock.
+     */
+    void preserve(const Leaf *leaf) {
+        const auto timestamp = _timestamp.load();
+        if (_count_views.load() == 0U) {
+            return;
+        }
+
+        auto &shard = this->shard(leaf);
+        auto lock = std::lock_guard{shard.mutex};
+        auto chain = Chain{};
+        const auto is_chained = shard.chains.lookup(std::uintptr_t(leaf), chain);
+        if (is_chained && chain.timestamp >= timestamp) {
+            return; /// Already preserved since the newest view was opened.
+        }
+
+        auto *version = new Version{timestamp, is_chained ? chain.head : nullptr, is_chained ? chain.timestamp : 0U, {}};
+        std::memcpy(static_cast<void *>(&version->image), static_cast<const void *>(leaf), sizeof(Leaf));
+        if (shard.chains.insert(std::uintptr_t(leaf), Chain{version, timestamp})) {
+            shard.chained_leaves.push_back(std::uintptr_t(leaf));
+        }
+        shard.versions.push_back(version);
+    }
+
+    /**
+     * Passes the images of the split leaf on to the new leaf; called by writers holding the leaf lock.
+     */
+    void share(const Leaf *leaf, const Leaf *new_leaf) {
+        if (_count_views.load() == 0U) {
+            return; /// Views opened later do not read any of the images.
+        }
+
+        auto chain = Chain{};
+        {
+            auto &shard = this->shard(leaf);
+            auto lock = std::lock_guard{shard.mutex};
+            if (shard.chains.lookup(std::uintptr_t(leaf), chain) == false) {
+                return;
+            }
+        }
+        auto &shard = this->shard(new_leaf);
+        auto lock = std::lock_guard{shard.mutex};
+        if (shard.chains.insert(std::uintptr_t(new_leaf), chain)) {
+            shard.chained_leaves.push_back(std::uintptr_t(new_leaf));
+        }
+    }
+
+    /**
+     * @return The image of the leaf the view reads, or nullptr if the view reads the leaf itself.
+     */
+    [[nodiscard]] const Leaf *image(const Leaf *leaf, const ReadView view) {
+        auto chain = Chain{};
+        {
+            auto &shard = this->shard(leaf);
+            auto lock = std::lock_guard{shard.mutex};
+            if (shard.chains.lookup(std::uintptr_t(leaf), chain) == false || chain.timestamp < view.timestamp) {
+                return nullptr;
+            }
+        }
+
+        auto *version = chain.head;
+        while (version->next != nullptr && version->next_timestamp >= view.timestamp) {
+            version = version->next;
+        }
+        return &version->image;
+    }
+
+    /**
+     * Frees the images that no open (or future) view reads, and drops the chains whose newest image is one
+     * of them (no view reads an image of these leaves).
+     */
+    void collect() {
+        auto oldest_view = std::uint64_t{0U};
+        {
+            auto lock = std::lock_guard{_views_mutex};
+            oldest_view = _views.empty() ? _timestamp.load() + 1U : *_views.begin();
+        }
+
+        for (auto &shard: _shards) {
+            auto lock = std::lock_guard{shard.mutex};
+            auto remaining = std::size_t{0U};
+            for (const auto leaf: shard.chained_leaves) {
+                auto chain = Chain{};
+                if (shard.chains.lookup(leaf, chain) && chain.timestamp < oldest_view) {
+                    shard.chains.remove(leaf);
+                } else {
+                    shard.chained_leaves[remaining++] = leaf;
+                }
+            }
+            shard.chained_leaves.resize(remaining);
+
+            remaining = 0U;
+            for (auto *version: shard.versions) {
+                if (version->timestamp < oldest_view) {
+                    delete version;
+                } else {
+                    shard.versions[remaining++] = version;
+                }
+            }
+            shard.versions.resize(remaining);
+        }
+    }
+
+    /**
+     * @return True, if at least one view is open.
+     */
+    [[nodiscard]] bool is_open() const noexcept { return _count_views.load(std::memory_order_relaxed) > 0U; }
+
+    /**
+     * @return Number of images that are not freed yet.
+     */
+    [[nodiscard]] std::uint64_t count_versions() {
+        auto count = std::uint64_t{0U};
+        for (auto &shard: _shards) {
+            auto lock = std::lock_guard{shard.mutex};
+            count += shard.versions.size();
+        }
+        return count;
+    }
+
+private:
+    /**
+     * Newest image of a leaf; images older than the oldest view are freed, their chains are not followed.
+     */
+    struct Chain {
+        Version *head{nullptr};
+        std::uint64_t timestamp{0U};
+    };
+
+    /**
+     * Chains of the leaves mapped to the shard and the images preserved from these leaves (a split may
+     * share an image with a leaf of another shard; the image is freed by the shard that preserved it).
+     */
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        OpenAddressingHashTable<std::uintptr_t, Chain> chains;
+
+        /// Keys of the chains, to drop the chains of images that are freed.
+        std::vector<std::uintptr_t> chained_leaves;
+        std::vector<Version *> versions;
+    };
+
+    static constexpr std::uint64_t count_shards = 64U;
+
+    /// Incremented by every opened view.
+    std::atomic<std::uint64_t> _timestamp{0U};
+    std::atomic<std::uint64_t> _count_views{0U};
+
+    std::mutex _views_mutex;
+    std::multiset<std::uint64_t> _views;
+
+    std::array<Shard, count_shards> _shards;
+
+    Shard &shard(const Leaf *leaf) noexcept { return _shards[(std::uintptr_t(leaf) / sizeof(Leaf)) % count_shards]; }
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <perfcpp/sampler.h>
+#include "btree_olc.h"
+
+/**
+ * Sampled loads of the nodes of one tree level.
+ */
+struct LevelStatistics {
+    std::uint64_t count_samples{0U};
+    std::uint64_t sum_latency{0U};
+
+    /// Data sources of the loads.
+    std::uint64_t count_l1{0U};
+    std::uint64_t count_lfb{0U};
+    std::uint64_t count_l2{0U};
+    std::uint64_t count_l3{0U};
+    std::uint64_t count_local_ram{0U};
+    std::uint64_t count_remote{0U};
+
+    [[nodiscard]] double average_latency() const noexcept {
+        return count_samples > 0U ? double(sum_latency) / double(count_samples) : 0.;
+    }
+
+    /**
+     * Every node is prefetched (as a whole) before the coroutine suspends; the load after resuming
+     * hits L1 if the prefetch completed, the line fill buffer if it is still in flight,
+     * and a farther level if the prefetch did not hide the miss.
+     *
+     * @return Fraction of loads served from L1.
+     */
+    [[nodiscard]] double hidden_fraction() const noexcept { return fraction(count_l1); }
+
+    /**
+     * @return Fraction of loads served from the line fill buffer (prefetch in flight, partly hidden).
+     */
+    [[nodiscard]] double in_flight_fraction() const noexcept { return fraction(count_lfb); }
+
+    /**
+     * @return Fraction of loads served beyond L1 (miss not hidden by the prefetch).
+     */
+    [[nodiscard]] double exposed_fraction() const noexcept {
+        return fraction(count_l2 + count_l3 + count_local_ram + count_remote);
+    }
+
+    [[nodiscard]] double fraction(const std::uint64_t count) const noexcept {
+        return count_samples > 0U ? double(count) / double(count_samples) : 0.;
+    }
+};
+
+/**
+ * Breaks sampled memory loads down by tree level (level 0 is the root). Samples are mapped to nodes
+ * through a sorted index of the node memory ranges and the height stored in every node, so that
+ * mapping neither traverses the tree nor depends on the number of nodes.
+ */
+class LevelBreakdown {
+public:
+    /**
+     * Builds the address index of the tree; the tree must not change until all samples are added.
+     *
+     * @param tree Tree whose nodes were sampled.
+     */
+    template<typename T>
+    explicit LevelBreakdown(const T &tree) : _page_size(T::page_size), _root_height(tree.root.load()->height) {
+        for (const auto &[begin, size]: tree.node_ranges()) {
+            const auto address = reinterpret_cast<std::uintptr_t>(begin);
+            _ranges.emplace_back(address, address + size);
+        }
+        std::sort(_ranges.begin(), _ranges.end());
+        _levels.resize(_root_height + 1U);
+    }
+
+    ~LevelBreakdown() = default;
+
+    /**
+     * Adds the samples that hit node memory to their level.
+     *
+     * @param samples Samples, recorded with logical memory address, latency, and data source.
+     */
+    void add(const std::vector<perf::Sample> &samples) {
+        for (const auto &sample: samples) {
+            const auto address = sample.logical_memory_address();
+            if (address.has_value() == false) {
+                continue;
+            }
+
+            const auto level = this->level(address.value());
+            if (level > _root_height) {
+                continue;
+            }
+
+            auto &statistics = _levels[level];
+            ++statistics.count_samples;
+            if (const auto weight = sample.weight(); weight.has_value()) {
+                statistics.sum_latency += weight->latency();
+            }
+            if (const auto data_source = sample.data_src(); data_source.has_value()) {
+                if (data_source->is_mem_l1()) {
+                    ++statistics.count_l1;
+                } else if (data_source->is_mem_lfb()) {
+                    ++statistics.count_lfb;
+                } else if (data_source->is_mem_l2()) {
+                    ++statistics.count_l2;
+                } else if (data_source->is_mem_l3()) {
+                    ++statistics.count_l3;
+                } else if (data_source->is_mem_local_ram()) {
+                    ++statistics.count_local_ram;
+                } else if (data_source->is_mem_remote_ram() || data_source->is_mem_remote_cce1() ||
+                           data_source->is_mem_remote_cce2()) {
+                    ++statistics.count_remote;
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] const std::vector<LevelStatistics> &levels() const noexcept { return _levels; }
+
+    [[nodiscard]] std::string to_string() const {
+        auto stream = std::stringstream{};
+        stream << std::setw(8) << "level" << std::setw(10) << "samples" << std::setw(10) << "latency"
+               << std::setw(8) << "L1" << std::setw(8) << "LFB" << std::setw(8) << "L2" << std::setw(8) << "L3"
+               << std::setw(8) << "DRAM" << std::setw(8) << "remote" << std::setw(10) << "hidden" << "\n";
+        stream << std::fixed << std::setprecision(2);
+        for (auto level = 0U; level < _levels.size(); ++level) {
+            const auto &statistics = _levels[level];
+            stream << std::setw(8) << name(level) << std::setw(10) << statistics.count_samples << std::setw(10)
+                   << statistics.average_latency() << std::setw(8) << statistics.fraction(statistics.count_l1)
+                   << std::setw(8) << statistics.fraction(statistics.count_lfb) << std::setw(8)
+                   << statistics.fraction(statistics.count_l2) << std::setw(8)
+                   << statistics.fraction(statistics.count_l3) << std::setw(8)
+                   << statistics.fraction(statistics.count_local_ram) << std::setw(8)
+                   << statistics.fraction(statistics.count_remote) << std::setw(10) << statistics.hidden_fraction()
+                   << "\n";
+        }
+        return stream.str();
+    }
+
+    [[nodiscard]] std::string to_json() const {
+        auto stream = std::stringstream{};
+        stream << "[";
+        for (auto level = 0U; level < _levels.size(); ++level) {
+            const auto &statistics = _levels[level];
+            stream << (level > 0U ? ", " : "") << "{ \"level\": \"" << name(level) << "\", \"samples\": "
+                   << statistics.count_samples << ", \"latency\": " << statistics.average_latency()
+                   << ", \"l1\": " << statistics.count_l1 << ", \"lfb\": " << statistics.count_lfb
+                   << ", \"l2\": " << statistics.count_l2 << ", \"l3\": " << statistics.count_l3
+                   << ", \"dram\": " << statistics.count_local_ram << ", \"remote\": " << statistics.count_remote
+                   << ", \"hidden\": " << statistics.hidden_fraction() << ", \"in-flight\": "
+                   << statistics.in_flight_fraction() << ", \"exposed\": " << statistics.exposed_fraction() << "}";
+        }
+        stream << "]";
+        return stream.str();
+    }
+
+private:
+    /// Begin and end of all node memory ranges, sorted by begin.
+    std::vector<std::pair<std::uintptr_t, std::uintptr_t>> _ranges;
+
+    /// Size (and alignment) of the nodes.
+    const std::size_t _page_size;
+
+    const std::uint8_t _root_height;
+
+    std::vector<LevelStatistics> _levels;
+
+    /**
+     * @return The level of the node containing the address, or a level beyond the leaves for addresses outside the tree.
+     */
+    [[nodiscard]] std::uint32_t level(const std::uintptr_t address) const noexcept {
+        const auto range = std::upper_bound(_ranges.begin(), _ranges.end(), address,
+                                            [](const auto value, const auto &range) { return value < range.first; });
+        if (range == _ranges.begin() || address >= std::prev(range)->second) {
+            return std::numeric_limits<std::uint32_t>::max();
+        }
+
+        const auto *node = reinterpret_cast<const NodeBase *>(address & ~(_page_size - 1U));
+        if (node->type != PageType::BTreeInner && node->type != PageType::BTreeLeaf) {
+            return std::numeric_limits<std::uint32_t>::max(); /// Memory not handed out, e.g., behind the last node.
+        }
+        return _root_height - std::min(node->height, _root_height);
+    }
+
+    [[nodiscard]] std::string name(const std::uint32_t level) const {
+        return level == _root_height ? std::string{"leaf"} : std::string{"lvl-"}.append(std::to_string(level));
+    }
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+/**
+ * Memory and coroutine costs of the machine, measured by Calibration::calibrate() (see src/calibration.h),
+ * and the interleaving depth derived from them. Executors take their default depth from the current profile.
+ */
+struct MachineProfile {
+    /// File the current profile is loaded from, unless the environment variable names another one.
+    static constexpr auto default_file = "machine-profile.txt";
+    static constexpr auto environment_variable = "CORO_TREE_MACHINE_PROFILE";
+
+    /// Depth used without a (valid) profile.
+    static constexpr std::uint16_t default_parallel_coroutines = 12U;
+
+    /// Cache levels a profile describes at most.
+    static constexpr std::uint64_t max_cache_levels = 8U;
+
+    std::string cpu{"unknown"};
+
+    /// Size of the data cache per level, L1 first.
+    std::vector<std::uint64_t> cache_sizes;
+
+    /// Latency of a dependent load (pointer chase) within a working set of half the cache, per level.
+    std::vector<double> cache_latencies_ns;
+
+    /// Latency of a dependent load within a working set far larger than the last-level cache.
+    double dram_latency_ns{0.};
+
+    /// Misses the core keeps in flight at best (DRAM latency per miss of independent pointer chases).
+    double parallel_misses{0.};
+
+    /// Cost of resuming a coroutine that suspends right away.
+    double coroutine_switch_ns{0.};
+
+    /// Cost of resuming a lookup for one node of a cache-resident tree (switch and node search).
+    double coroutine_step_ns{0.};
+
+    /// Interleaving depth: Enough coroutines to cover the DRAM latency, but not more than misses in flight.
+    std::uint16_t parallel_coroutines{default_parallel_coroutines};
+
+    /**
+     * @return Interleaving depth that hides the DRAM latency behind the steps of other coroutines, bounded
+     *  by the misses the core can keep in flight and the frames of the coroutine allocator (32).
+     */
+    [[nodiscard]] std::uint16_t derive_parallel_coroutines() const noexcept {
+        if (dram_latency_ns <= 0. || coroutine_step_ns <= 0.) {
+            return default_parallel_coroutines;
+        }
+
+        const auto covering = std::uint64_t(dram_latency_ns / coroutine_step_ns) + 1U;
+        const auto in_flight = std::max<std::uint64_t>(1U, std::uint64_t(parallel_misses + .5));
+        return std::uint16_t(std::clamp<std::uint64_t>(std::min(covering, in_flight), 1U, 32U));
+    }
+
+    /**
+     * Writes the profile as lines of "key value".
+     *
+     * @return True, if the file was written.
+     */
+    bool save(const std::string &file_name) const {
+        auto out_stream = std::ofstream{file_name, std::ios::trunc};
+        if (out_stream.is_open() == false) {
+            return false;
+        }
+
+        out_stream << "cpu " << cpu << "\n";
+        for (auto level = 0U; level < cache_sizes.size(); ++level) {
+            out_stream << "cache-bytes-l" << level + 1U << " " << cache_sizes[level] << "\n";
+        }
+        for (auto level = 0U; level < cache_latencies_ns.size(); ++level) {
+            out_stream << "latency-ns-l" << level + 1U << " " << cache_latencies_ns[level] << "\n";
+        }
+        out_stream << "latency-ns-dram " << dram_latency_ns << "\n"
+                   << "parallel-misses " << parallel_misses << "\n"
+                   << "coroutine-switch-ns " << coroutine_switch_ns << "\n"
+                   << "coroutine-step-ns " << coroutine_step_ns << "\n"
+                   << "parallel-coroutines " << parallel_coroutines << "\n";
+        return out_stream.good();
+    }
+
+    /**
+     * @return The profile stored in the file, or nothing if the file does not exist, holds a malformed number,
+     *  or holds no valid depth. Does not throw, as the current profile is loaded by a static initializer.
+     */
+    [[nodiscard]] static std::optional<MachineProfile> load(const std::string &file_name) {
+        auto in_stream = std::ifstream{file_name};
+        if (in_stream.is_open() == false) {
+            return std::nullopt;
+        }
+
+        auto profile = MachineProfile{};
+        profile.parallel_coroutines = 0U;
+        auto line = std::string{};
+        while (std::getline(in_stream, line)) {
+            const auto separator = line.find(' ');
+            if (separator == std::string::npos) {
+                continue;
+            }
+            const auto key = std::string_view{line}.substr(0U, separator);
+            const auto value = std::string_view{line}.substr(separator + 1U);
+
+            auto is_valid = true;
+            if (key == "cpu") {
+                profile.cpu = value;
+            } else if (key.starts_with("cache-bytes-l")) {
+                auto *size = at_level(profile.cache_sizes, key, "cache-bytes-l");
+                is_valid = size != nullptr && parse(value, *size);
+            } else if (key.starts_with("latency-ns-l")) {
+                auto *latency = at_level(profile.cache_latencies_ns, key, "latency-ns-l");
+                is_valid = latency != nullptr && parse(value, *latency);
+            } else if (key == "latency-ns-dram") {
+                is_valid = parse(value, profile.dram_latency_ns);
+            } else if (key == "parallel-misses") {
+                is_valid = parse(value, profile.parallel_misses);
+            } else if (key == "coroutine-switch-ns") {
+                is_valid = parse(value, profile.coroutine_switch_ns);
+            } else if (key == "coroutine-step-ns") {
+                is_valid = parse(value, profile.coroutine_step_ns);
+            } else if (key == "parallel-coroutines") {
+                is_valid = parse(value, profile.parallel_coroutines);
+            }
+
+            if (is_valid == false) {
+                return std::nullopt;
+            }
+        }
+
+        if (profile.parallel_coroutines == 0U || profile.parallel_coroutines > 32U) {
+            return std::nullopt;
+        }
+        return profile;
+    }
+
+    /**
+     * @return The profile of this machine, loaded once from the file named by CORO_TREE_MACHINE_PROFILE
+     *  (default: machine-profile.txt in the working directory); defaults if there is none.
+     */
+    [[nodiscard]] static const MachineProfile &current() {
+        static const auto profile = []() {
+            const auto *file_name = std::getenv(environment_variable);
+            return load(file_name != nullptr ? file_name : default_file).value_or(MachineProfile{});
+        }();
+        return profile;
+    }
+
+    [[nodiscard]] std::string to_string() const {
+        auto stream = std::stringstream{};
+        stream << std::fixed << std::setprecision(2) << "cpu: " << cpu << "\n";
+        for (auto level = 0U; level < cache_latencies_ns.size(); ++level) {
+            stream << "L" << level + 1U << " latency: " << cache_latencies_ns[level] << " ns";
+            if (level < cache_sizes.size()) {
+                stream << " (" << cache_sizes[level] / 1024U << " KiB)";
+            }
+            stream << "\n";
+        }
+        stream << "DRAM latency: " << dram_latency_ns << " ns\n"
+               << "parallel misses: " << parallel_misses << "\n"
+               << "coroutine switch: " << coroutine_switch_ns << " ns, step: " << coroutine_step_ns << " ns\n"
+               << "parallel coroutines: " << parallel_coroutines << "\n";
+        return stream.str();
+    }
+
+    [[nodiscard]] std::string to_json() const {
+        auto stream = std::stringstream{};
+        stream << "{ \"cpu\": \"" << cpu << "\", \"latencies-ns\": [";
+        for (auto level = 0U; level < cache_latencies_ns.size(); ++level) {
+            stream << (level > 0U ? ", " : "") << cache_latencies_ns[level];
+        }
+        stream << "], \"dram-latency-ns\": " << dram_latency_ns << ", \"parallel-misses\": " << parallel_misses
+               << ", \"coroutine-switch-ns\": " << coroutine_switch_ns << ", \"coroutine-step-ns\": "
+               << coroutine_step_ns << ", \"parallel-coroutines\": " << parallel_coroutines << "}";
+        return stream.str();
+    }
+
+private:
+    /**
+     * Parses the number, which may be followed by whitespace only.
+     *
+     * @return True, if the text is a number of the type.
+     */
+    template<typename T>
+    static bool parse(const std::string_view text, T &value) noexcept {
+        const auto *end = text.data() + text.size();
+        const auto [number_end, error] = std::from_chars(text.data(), end, value);
+        return error == std::errc{} && std::all_of(number_end, end, [](const char character) {
+            return character == ' ' || character == '\t' || character == '\r';
+        });
+    }
+
+    /**
+     * @return The entry of the level encoded in the key (e.g., 2 for "latency-ns-l2"), growing the vector;
+     *  nullptr if the key encodes no level up to max_cache_levels.
+     */
+    template<typename T>
+    static T *at_level(std::vector<T> &values, const std::string_view key, const std::string_view prefix) {
+        auto level = std::uint64_t{0U};
+        if (parse(key.substr(prefix.size()), level) == false || level == 0U || level > max_cache_levels) {
+            return nullptr;
+        }
+        if (values.size() < level) {
+            values.resize(level, T{0});
+        }
+        return &values[level - 1U];
+    }
+};
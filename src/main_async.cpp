@@ -0,0 +1,66 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include "coroutine/coroutine_async_executor.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+int main() {
+    /// Create the workload.
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto lookup_requests = 10000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+
+    /// Threads that submit requests, and the number of requests each client awaits at once.
+    constexpr auto count_clients = 4U;
+    constexpr auto outstanding_requests = 64U;
+
+    auto tree = BTree<std::uint64_t, std::uint64_t>{};
+
+    /// Execute the insert_requests phase.
+    std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::flush;
+    CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+    std::cout << "done." << std::endl;
+
+    /// Submit the lookups from client threads, one request at a time.
+    std::cout << "Submitting " << lookup_requests << " lookup requests from " << count_clients << " clients..."
+              << std::flush;
+    const auto start_timestamp = std::chrono::steady_clock::now();
+    {
+        using Executor = CoroutineAsyncExecutor<BTree<std::uint64_t, std::uint64_t>>;
+        auto executor = Executor{tree};
+        const auto &requests = benchmark_set.mixed_requests();
+
+        auto clients = std::vector<std::thread>{};
+        for (auto client_id = 0U; client_id < count_clients; ++client_id) {
+            clients.emplace_back([&, client_id] {
+                /// Requests owned by the client and reused, so that submitting does not allocate.
+                auto outstanding = std::vector<Executor::Request>(outstanding_requests);
+                auto count_outstanding = 0U;
+                for (auto index = std::uint64_t(client_id); index < requests.size(); index += count_clients) {
+                    auto &request = outstanding[count_outstanding++];
+                    request.tuple = requests[index];
+                    executor.submit(request);
+                    if (count_outstanding == outstanding_requests) {
+                        for (const auto &outstanding_request: outstanding) {
+                            outstanding_request.wait();
+                        }
+                        count_outstanding = 0U;
+                    }
+                }
+                for (auto i = 0U; i < count_outstanding; ++i) {
+                    outstanding[i].wait();
+                }
+            });
+        }
+        for (auto &client: clients) {
+            client.join();
+        }
+    }
+    const auto end_timestamp = std::chrono::steady_clock::now();
+    const auto lookup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+    std::cout << "done (" << double(lookup_requests) / (double(lookup_ms) / 1000.) << " lookups/s)" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include <iostream>
+#include "index_backend.h"
+#include "perf_event_counters.h"
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+
+/**
+ * Throughput, latencies, and hardware counters (per request) of one backend in one phase.
+ */
+struct PhaseResult {
+    std::string backend;
+    double throughput;
+    std::chrono::nanoseconds p50;
+    std::chrono::nanoseconds p99;
+    std::chrono::nanoseconds p999;
+    std::array<double, 5U> counters;
+};
+
+/// Names of the hardware counters (in the order of the counters of a PhaseResult).
+const auto counter_names = std::array<std::string, 5U>{"cycles", "instructions", "LLC-misses", "branch-misses",
+                                                       PerfEventCounters::dtlb_load_misses};
+
+PhaseResult execute(IndexBackend &backend, const std::vector<NumericTuple> &workload) {
+    auto perf_event = PerfEvent{};
+    PerfEventCounters::add_dtlb_load_misses(perf_event);
+    auto latencies = RequestLatencies{workload.size()};
+
+    perf_event.startCounters();
+    const auto start_timestamp = std::chrono::steady_clock::now();
+    backend.execute(workload, latencies);
+    const auto end_timestamp = std::chrono::steady_clock::now();
+    perf_event.stopCounters();
+
+    const auto seconds = std::chrono::duration<double>(end_timestamp - start_timestamp).count();
+    auto result = PhaseResult{backend.name(), double(workload.size()) / seconds, latencies.percentile(.5),
+                              latencies.percentile(.99), latencies.percentile(.999), {}};
+    for (auto i = 0U; i < counter_names.size(); ++i) {
+        const auto value = perf_event.getCounter(counter_names[i]);
+        result.counters[i] = value >= 0. ? value / double(workload.size()) : -1.;
+    }
+    return result;
+}
+
+void print(const std::string &phase, const std::vector<PhaseResult> &results) {
+    const auto to_us = [](const std::chrono::nanoseconds latency) { return double(latency.count()) / 1000.; };
+
+    std::cout << "\n" << phase << " phase (latencies in us, counters per request; -1 if not available)\n"
+              << std::setw(18) << "backend" << std::setw(14) << "requests/s" << std::setw(9) << "p50"
+              << std::setw(9) << "p99" << std::setw(9) << "p99.9";
+    for (const auto &name: counter_names) {
+        std::cout << std::setw(17) << name;
+    }
+    std::cout << "\n" << std::fixed << std::setprecision(2);
+    for (const auto &result: results) {
+        std::cout << std::setw(18) << result.backend << std::setw(14) << std::setprecision(0) << result.throughput
+                  << std::setprecision(2) << std::setw(9) << to_us(result.p50) << std::setw(9) << to_us(result.p99)
+                  << std::setw(9) << to_us(result.p999);
+        for (const auto counter: result.counters) {
+            std::cout << std::setw(17) << counter;
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+}
+
+int main() {
+    /// Create the workload; all backends execute the identical requests.
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto lookup_requests = 50000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+
+    auto backends = std::vector<std::unique_ptr<IndexBackend>>{};
+    backends.emplace_back(std::make_unique<CoroutineTreeBackend>());
+    backends.emplace_back(std::make_unique<SynchronousTreeBackend>());
+    backends.emplace_back(std::make_unique<StdMapBackend>());
+    backends.emplace_back(std::make_unique<HashTableBackend>());
+
+    auto insert_results = std::vector<PhaseResult>{};
+    auto lookup_results = std::vector<PhaseResult>{};
+    for (auto &backend: backends) {
+        std::cout << "Executing " << insert_requests << " insert_requests requests on " << backend->name() << "..."
+                  << std::flush;
+        insert_results.emplace_back(execute(*backend, benchmark_set.insert_requests()));
+        std::cout << "done (" << backend->allocated_bytes() / (1024. * 1024.) << " MiB)" << std::endl;
+
+        std::cout << "Executing " << lookup_requests << " lookup requests on " << backend->name() << "..."
+                  << std::flush;
+        lookup_results.emplace_back(execute(*backend, benchmark_set.mixed_requests()));
+        std::cout << "done" << std::endl;
+
+        /// Free the memory of the backend before running the next one.
+        backend.reset();
+    }
+
+    print("Insert", insert_results);
+    print("Lookup", lookup_results);
+
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+/**
+ * Inserts the workload into a new tree, one coroutine per request or batched, and reports the throughput.
+ */
+void run(const std::string &name, const std::vector<NumericTuple> &workload, const bool is_batched) {
+    auto tree = BTree<std::uint64_t, std::uint64_t>{};
+
+    std::cout << "  " << name << (is_batched ? " (batched): " : ": ") << std::flush;
+    const auto start_timestamp = std::chrono::steady_clock::now();
+    if (is_batched) {
+        CoroutineRoundRobinExecutor::execute_batched(tree, workload);
+    } else {
+        CoroutineRoundRobinExecutor::execute(tree, workload);
+    }
+    const auto end_timestamp = std::chrono::steady_clock::now();
+    const auto insert_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+    std::cout << double(workload.size()) / (double(insert_ms) / 1000.) << " inserts/s" << std::endl;
+}
+
+int main() {
+    constexpr auto insert_requests = 20000000ULL;
+
+    /// Keys of a cluster are consecutive; clusters start at random keys.
+    constexpr auto cluster_size = 256ULL;
+
+    /// Requests arrive in random order within blocks of this size.
+    constexpr auto shuffle_size = 4096ULL;
+
+    auto random = std::mt19937_64{insert_requests};
+
+    /// Create the workloads.
+    auto sequential = std::vector<NumericTuple>{};
+    auto clustered = std::vector<NumericTuple>{};
+    auto uniform = std::vector<NumericTuple>{};
+    sequential.reserve(insert_requests);
+    clustered.reserve(insert_requests);
+    uniform.reserve(insert_requests);
+    for (auto i = 0ULL; i < insert_requests; ++i) {
+        sequential.emplace_back(NumericTuple::Type::INSERT, i, i);
+        uniform.emplace_back(NumericTuple::Type::INSERT, random(), i);
+    }
+    for (auto cluster = 0ULL; cluster < insert_requests / cluster_size; ++cluster) {
+        const auto base = random() >> 1U;
+        for (auto i = 0ULL; i < cluster_size; ++i) {
+            clustered.emplace_back(NumericTuple::Type::INSERT, base + i, i);
+        }
+    }
+    for (auto block = 0ULL; block < insert_requests; block += shuffle_size) {
+        const auto end = std::min(block + shuffle_size, insert_requests);
+        std::shuffle(clustered.begin() + block, clustered.begin() + end, random);
+    }
+
+    std::cout << "Executing " << insert_requests << " insert_requests requests per workload..." << std::endl;
+    for (const auto is_batched: {false, true}) {
+        run("sequential", sequential, is_batched);
+        run("clustered", clustered, is_batched);
+        run("uniform", uniform, is_batched);
+    }
+
+    return 0;
+}
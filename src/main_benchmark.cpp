@@ -0,0 +1,326 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include "workload/key_permutation.h"
+#include "workload/zipf_distribution.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/// Number of entries of the tree.
+constexpr auto sizes = std::array<std::uint64_t, 3U>{1000000ULL, 10000000ULL, 100000000ULL};
+
+/// Number of coroutines interleaved by the executor.
+constexpr auto depths = std::array<std::uint64_t, 4U>{1U, 4U, 12U, 24U};
+
+/// Runs per configuration; warm-up runs are not recorded.
+constexpr auto warm_up_runs = 1U;
+constexpr auto repetitions = 5U;
+
+/// Upper bound of requests per (non-insert) workload, to keep runs on large trees short.
+constexpr auto max_requests = 10000000ULL;
+
+/// Entries read by each scan request.
+constexpr auto scan_length = 100ULL;
+
+constexpr auto seed = 1337ULL;
+
+using Configuration = std::tuple<std::string, std::uint64_t, std::uint64_t>;
+
+/**
+ * Mean and 95% confidence interval of a set of throughputs.
+ */
+struct Summary {
+    std::uint64_t count{0U};
+    double mean{0.};
+    double variance{0.};
+
+    explicit Summary(const std::vector<double> &values) : count(values.size()) {
+        if (count > 0U) {
+            mean = std::accumulate(values.begin(), values.end(), 0.) / double(count);
+        }
+        if (count > 1U) {
+            for (const auto value: values) {
+                variance += (value - mean) * (value - mean);
+            }
+            variance /= double(count - 1U);
+        }
+    }
+
+    [[nodiscard]] double standard_error() const noexcept { return count > 0U ? std::sqrt(variance / double(count)) : 0.; }
+};
+
+/**
+ * @return The two-sided 95% quantile of Student's t-distribution.
+ */
+double t_quantile(const double degrees_of_freedom) {
+    constexpr auto quantiles = std::array<double, 30U>{
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131,
+            2.120, 2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (degrees_of_freedom < 1.) {
+        return quantiles.front();
+    }
+    if (degrees_of_freedom > 30.) {
+        return 1.960;
+    }
+    return quantiles[std::uint64_t(degrees_of_freedom) - 1U];
+}
+
+/**
+ * Creates the workloads for a tree of the given size; keys of the tree are 0..size-1.
+ */
+std::map<std::string, std::vector<NumericTuple>> create_workloads(const std::uint64_t size) {
+    auto random = std::mt19937_64{seed + size};
+    const auto count_requests = std::min<std::uint64_t>(size, max_requests);
+    auto uniform = std::uniform_int_distribution<std::uint64_t>{0U, size - 1U};
+
+    auto workloads = std::map<std::string, std::vector<NumericTuple>>{};
+
+    auto &insert = workloads["insert"];
+    insert.reserve(size);
+    const auto permutation = KeyPermutation{size, seed + size};
+    for (auto i = 0ULL; i < size; ++i) {
+        const auto key = permutation(i);
+        insert.emplace_back(NumericTuple::Type::INSERT, key, std::int64_t(key));
+    }
+
+    auto &lookup = workloads["lookup"];
+    lookup.reserve(count_requests);
+    for (auto i = 0ULL; i < count_requests; ++i) {
+        lookup.emplace_back(NumericTuple::Type::LOOKUP, uniform(random));
+    }
+
+    /// Half lookups, half updates of existing keys.
+    auto &mixed = workloads["mixed"];
+    mixed.reserve(count_requests);
+    for (auto i = 0ULL; i < count_requests; ++i) {
+        const auto key = uniform(random);
+        if (i & 1U) {
+            mixed.emplace_back(NumericTuple::Type::UPDATE, key, std::int64_t(key + 1U));
+        } else {
+            mixed.emplace_back(NumericTuple::Type::LOOKUP, key);
+        }
+    }
+
+    auto &scan = workloads["scan"];
+    scan.reserve(count_requests / scan_length);
+    for (auto i = 0ULL; i < count_requests / scan_length; ++i) {
+        scan.emplace_back(NumericTuple::Type::SCAN, uniform(random), std::int64_t(scan_length));
+    }
+
+    /// Zipfian lookups; ranks are scattered over the key space so that hot keys do not share leaves.
+    auto &skewed = workloads["skewed"];
+    skewed.reserve(count_requests);
+    auto zipf = ZipfDistribution{size, .99};
+    for (auto i = 0ULL; i < count_requests; ++i) {
+        skewed.emplace_back(NumericTuple::Type::LOOKUP, (zipf(random) * 0x9E3779B97F4A7C15ULL) % size);
+    }
+
+    /// Read-modify-writes of existing keys: Increments, compare-and-sets, and inserts-if-absent in turns.
+    auto &rmw = workloads["rmw"];
+    rmw.reserve(count_requests);
+    for (auto i = 0ULL; i < count_requests; ++i) {
+        const auto key = uniform(random);
+        if (i % 3U == 0U) {
+            rmw.emplace_back(NumericTuple::Type::ADD, key, 1);
+        } else if (i % 3U == 1U) {
+            rmw.push_back(NumericTuple::compare_and_set(key, std::uint32_t(key), std::uint32_t(key + 1U)));
+        } else {
+            rmw.emplace_back(NumericTuple::Type::INSERT_IF_ABSENT, key, std::int64_t(key));
+        }
+    }
+
+    return workloads;
+}
+
+/**
+ * @return Requests per second.
+ */
+double measure(const std::function<void()> &execute, const std::uint64_t count_requests) {
+    const auto start = std::chrono::steady_clock::now();
+    execute();
+    const auto end = std::chrono::steady_clock::now();
+    return double(count_requests) / std::chrono::duration<double>(end - start).count();
+}
+
+std::map<Configuration, std::vector<double>> read_results(const std::string &file_name) {
+    auto results = std::map<Configuration, std::vector<double>>{};
+    auto in_stream = std::ifstream{file_name};
+    if (in_stream.good() == false) {
+        std::cerr << "Could not open '" << file_name << "'." << std::endl;
+        return results;
+    }
+
+    auto line = std::string{};
+    std::getline(in_stream, line); /// Header.
+    while (std::getline(in_stream, line)) {
+        auto line_stream = std::stringstream{line};
+        auto workload = std::string{}, size = std::string{}, depth = std::string{}, repetition = std::string{},
+                throughput = std::string{};
+        if (std::getline(line_stream, workload, ',') && std::getline(line_stream, size, ',') &&
+            std::getline(line_stream, depth, ',') && std::getline(line_stream, repetition, ',') &&
+            std::getline(line_stream, throughput, ',')) {
+            results[Configuration{workload, std::stoull(size), std::stoull(depth)}].emplace_back(std::stod(throughput));
+        }
+    }
+    return results;
+}
+
+/**
+ * Compares every configuration to the baseline; a configuration regressed (or improved)
+ * if the 95% confidence interval of the difference of the means (Welch) lies below (or above) zero.
+ *
+ * @return Number of regressions.
+ */
+std::uint64_t compare(const std::map<Configuration, std::vector<double>> &results,
+                      const std::map<Configuration, std::vector<double>> &baseline) {
+    auto count_regressions = 0ULL;
+
+    std::cout << "\n" << std::setw(8) << "workload" << std::setw(12) << "size" << std::setw(7) << "depth"
+              << std::setw(14) << "baseline" << std::setw(14) << "current" << std::setw(10) << "change"
+              << std::setw(22) << "95% CI" << "  verdict\n";
+    std::cout << std::fixed;
+    for (const auto &[configuration, values]: results) {
+        const auto &[workload, size, depth] = configuration;
+        const auto baseline_values = baseline.find(configuration);
+        if (baseline_values == baseline.end()) {
+            continue;
+        }
+
+        const auto current = Summary{values};
+        const auto previous = Summary{baseline_values->second};
+
+        /// Welch-Satterthwaite degrees of freedom.
+        const auto current_variance = current.standard_error() * current.standard_error();
+        const auto previous_variance = previous.standard_error() * previous.standard_error();
+        const auto difference_error = std::sqrt(current_variance + previous_variance);
+        auto degrees_of_freedom = 1.;
+        if (current.count > 1U && previous.count > 1U && difference_error > 0.) {
+            degrees_of_freedom = std::pow(current_variance + previous_variance, 2.) /
+                                 (current_variance * current_variance / double(current.count - 1U) +
+                                  previous_variance * previous_variance / double(previous.count - 1U));
+        }
+
+        const auto difference = current.mean - previous.mean;
+        const auto margin = t_quantile(degrees_of_freedom) * difference_error;
+        const auto lower = (difference - margin) / previous.mean * 100.;
+        const auto upper = (difference + margin) / previous.mean * 100.;
+
+        auto verdict = std::string{"~"};
+        if (upper < 0.) {
+            verdict = "REGRESSION";
+            ++count_regressions;
+        } else if (lower > 0.) {
+            verdict = "improvement";
+        }
+
+        auto interval = std::stringstream{};
+        interval << std::fixed << std::setprecision(1) << "[" << lower << "%, " << upper << "%]";
+        std::cout << std::setw(8) << workload << std::setw(12) << size << std::setw(7) << depth << std::setprecision(0)
+                  << std::setw(14) << previous.mean << std::setw(14) << current.mean << std::setprecision(1)
+                  << std::setw(9) << difference / previous.mean * 100. << "%" << std::setw(22) << interval.str()
+                  << "  " << verdict << "\n";
+    }
+    std::cout << std::flush;
+
+    return count_regressions;
+}
+
+int main(int count_arguments, char **arguments) {
+    if (count_arguments < 2) {
+        std::cout << "Usage: " << arguments[0] << " <results.csv> [--baseline <baseline.csv>] [--max-size <entries>]"
+                  << std::endl;
+        return 1;
+    }
+
+    const auto result_file_name = std::string{arguments[1]};
+    auto baseline_file_name = std::string{};
+    auto max_size = 10000000ULL;
+    for (auto i = 2; i + 1 < count_arguments; i += 2) {
+        const auto argument = std::string{arguments[i]};
+        if (argument == "--baseline") {
+            baseline_file_name = arguments[i + 1];
+        } else if (argument == "--max-size") {
+            max_size = std::stoull(arguments[i + 1]);
+        }
+    }
+
+    auto out_stream = std::ofstream{result_file_name};
+    out_stream << "workload,size,depth,repetition,throughput\n" << std::fixed << std::setprecision(1);
+
+    auto results = std::map<Configuration, std::vector<double>>{};
+    for (const auto size: sizes) {
+        if (size > max_size) {
+            break;
+        }
+
+        std::cout << "Creating workloads for " << size << " entries..." << std::flush;
+        const auto workloads = create_workloads(size);
+        std::cout << "done." << std::endl;
+
+        for (const auto depth: depths) {
+            for (auto run = 0U; run < warm_up_runs + repetitions; ++run) {
+                const auto is_warm_up = run < warm_up_runs;
+                auto record = [&](const std::string &workload, const double throughput) {
+                    if (is_warm_up == false) {
+                        results[Configuration{workload, size, depth}].emplace_back(throughput);
+                        out_stream << workload << "," << size << "," << depth << "," << run - warm_up_runs << ","
+                                   << throughput << std::endl;
+                    }
+                };
+
+                /// Every run inserts into a fresh tree, the other workloads run on the filled tree.
+                auto tree = BTree<std::uint64_t, std::uint64_t>{};
+                for (const auto *workload: {"insert", "lookup", "mixed", "scan", "skewed", "rmw"}) {
+                    const auto &requests = workloads.at(workload);
+                    const auto throughput = measure([&] {
+                        CoroutineRoundRobinExecutor::execute(tree, requests, nullptr, depth);
+                    }, requests.size());
+                    record(workload, throughput);
+                }
+
+                /// The mixed requests again, resumed by their annotations instead of round-robin.
+                const auto &requests = workloads.at("mixed");
+                record("sched", measure([&] {
+                    CoroutineRoundRobinExecutor::execute_scheduled(tree, requests, nullptr, depth);
+                }, requests.size()));
+
+                std::cout << "size=" << size << " depth=" << depth << (is_warm_up ? " (warm-up)" : "")
+                          << " done." << std::endl;
+            }
+        }
+    }
+
+    /// Mean and confidence interval of every configuration.
+    std::cout << "\n" << std::setw(8) << "workload" << std::setw(12) << "size" << std::setw(7) << "depth"
+              << std::setw(14) << "ops/s" << std::setw(12) << "+- 95% CI" << "\n";
+    for (const auto &[configuration, values]: results) {
+        const auto &[workload, size, depth] = configuration;
+        const auto summary = Summary{values};
+        const auto margin = t_quantile(double(summary.count - 1U)) * summary.standard_error();
+        std::cout << std::setw(8) << workload << std::setw(12) << size << std::setw(7) << depth << std::fixed
+                  << std::setprecision(0) << std::setw(14) << summary.mean << std::setw(12) << margin << "\n";
+    }
+    std::cout << std::flush;
+
+    if (baseline_file_name.empty() == false) {
+        const auto count_regressions = compare(results, read_results(baseline_file_name));
+        if (count_regressions > 0U) {
+            std::cout << count_regressions << " configuration(s) regressed." << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
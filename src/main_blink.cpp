@@ -0,0 +1,68 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/**
+ * Executes every share of the requests on the tree from its own thread.
+ *
+ * @return Requests per second.
+ */
+template<typename T>
+double execute_parallel(T &tree, const std::vector<std::vector<NumericTuple>> &shares) {
+    const auto start_timestamp = std::chrono::steady_clock::now();
+    auto threads = std::vector<std::thread>{};
+    auto count_requests = std::uint64_t{0U};
+    for (const auto &share: shares) {
+        count_requests += share.size();
+        threads.emplace_back([&tree, &share] { CoroutineRoundRobinExecutor::execute(tree, share); });
+    }
+    for (auto &thread: threads) {
+        thread.join();
+    }
+    const auto end_timestamp = std::chrono::steady_clock::now();
+    return double(count_requests) / std::chrono::duration<double>(end_timestamp - start_timestamp).count();
+}
+
+/**
+ * @return The requests, dealt round-robin into count_threads shares.
+ */
+std::vector<std::vector<NumericTuple>> deal(const std::vector<NumericTuple> &requests, const std::uint32_t count_threads) {
+    auto shares = std::vector<std::vector<NumericTuple>>(count_threads);
+    for (auto i = 0ULL; i < requests.size(); ++i) {
+        shares[i % count_threads].emplace_back(requests[i]);
+    }
+    return shares;
+}
+
+int main() {
+    /// Create the workload.
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto lookup_requests = 50000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+
+    const auto max_threads = std::max(1U, std::thread::hardware_concurrency());
+    for (auto count_threads = 1U; count_threads <= max_threads; count_threads *= 2U) {
+        std::cout << "\n" << count_threads << " thread(s)" << std::endl;
+        const auto insert_shares = deal(benchmark_set.insert_requests(), count_threads);
+        const auto lookup_shares = deal(benchmark_set.mixed_requests(), count_threads);
+
+        for (const auto synchronization: {Synchronization::LockCoupling, Synchronization::BLink}) {
+            auto tree = BTree<std::uint64_t, std::uint64_t>{};
+            tree.synchronization = synchronization;
+
+            /// Concurrent inserts split nodes all the time, other inserts descending meanwhile conflict.
+            const auto inserts_per_second = execute_parallel(tree, insert_shares);
+            const auto lookups_per_second = execute_parallel(tree, lookup_shares);
+
+            std::cout << "  " << (synchronization == Synchronization::BLink ? "b-link:       " : "lock coupling:")
+                      << " " << inserts_per_second << " inserts/s, " << lookups_per_second << " lookups/s"
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}
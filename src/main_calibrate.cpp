@@ -0,0 +1,21 @@
+#include <iostream>
+#include "calibration.h"
+#include <string>
+
+int main(const int count_arguments, char **arguments) {
+    /// The executors load the profile from this file (unless CORO_TREE_MACHINE_PROFILE names another one).
+    const auto file_name = count_arguments > 1 ? std::string{arguments[1]} : std::string{MachineProfile::default_file};
+
+    std::cout << "Calibrating..." << std::flush;
+    const auto profile = Calibration::calibrate();
+    std::cout << "done\n" << profile.to_string() << std::flush;
+
+    if (profile.save(file_name)) {
+        std::cout << "Stored the profile in '" << file_name << "'." << std::endl;
+    } else {
+        std::cout << "Could not write '" << file_name << "'." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,46 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "btree_compressed_leaf.h"
+#include "btree_fingerprint_leaf.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include <chrono>
+
+/**
+ * Executes both phases on the given tree and reports the size of the tree and the insert and lookup throughput.
+ */
+template<typename T>
+void run(const std::string &name, const NumericWorkloadSet &benchmark_set) {
+    auto tree = T{};
+
+    std::cout << name << ": " << T::Leaf::maxEntries << " entries per leaf (at most)" << std::endl;
+    std::cout << "  Executing " << benchmark_set.insert_requests().size() << " insert_requests requests..." << std::flush;
+    const auto insert_start_timestamp = std::chrono::steady_clock::now();
+    CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+    const auto insert_end_timestamp = std::chrono::steady_clock::now();
+    const auto insert_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(insert_end_timestamp - insert_start_timestamp).count();
+    std::cout << "done (" << double(benchmark_set.insert_requests().size()) / (double(insert_ms) / 1000.)
+              << " inserts/s, " << tree.node_allocator.allocated_bytes() / (1024. * 1024.) << " MiB of nodes)"
+              << std::endl;
+
+    std::cout << "  Executing " << benchmark_set.mixed_requests().size() << " lookup requests..." << std::flush;
+    const auto start_timestamp = std::chrono::steady_clock::now();
+    CoroutineRoundRobinExecutor::execute(tree, benchmark_set.mixed_requests());
+    const auto end_timestamp = std::chrono::steady_clock::now();
+    const auto lookup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+    std::cout << "done (" << double(benchmark_set.mixed_requests().size()) / (double(lookup_ms) / 1000.)
+              << " lookups/s)" << std::endl;
+}
+
+int main() {
+    /// Create the workload.
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto lookup_requests = 50000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+
+    run<BTree<std::uint64_t, std::uint64_t>>("Leaves with 8 byte keys", benchmark_set);
+    run<BTree<std::uint64_t, std::uint64_t, 256U, BTreeCompressedLeaf>>("Leaves with delta-encoded keys", benchmark_set);
+    run<BTree<std::uint64_t, std::uint64_t, 256U, BTreeFingerprintLeaf>>("Unsorted leaves with fingerprints", benchmark_set);
+
+    return 0;
+}
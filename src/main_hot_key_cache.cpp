@@ -0,0 +1,63 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include "workload/zipf_distribution.h"
+#include <chrono>
+#include <memory>
+#include <random>
+
+int main() {
+    /// Create the workload.
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto lookup_requests = 50000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, 0U};
+
+    /// Number of keys held by the cache.
+    constexpr auto cache_capacity = 4096ULL;
+
+    /// Zipfian lookups (ranks scattered over the key space), optionally with updates.
+    auto random = std::mt19937_64{1337U};
+    auto zipf = ZipfDistribution{insert_requests, .99};
+    auto read_only = std::vector<NumericTuple>{};
+    auto read_mostly = std::vector<NumericTuple>{};
+    read_only.reserve(lookup_requests);
+    read_mostly.reserve(lookup_requests);
+    for (auto i = 0ULL; i < lookup_requests; ++i) {
+        const auto key = (zipf(random) * 0x9E3779B97F4A7C15ULL) % insert_requests;
+        read_only.emplace_back(NumericTuple::Type::LOOKUP, key);
+        if (random() % 100U < 5U) {
+            read_mostly.emplace_back(NumericTuple::Type::UPDATE, key, std::int64_t(i));
+        } else {
+            read_mostly.emplace_back(NumericTuple::Type::LOOKUP, key);
+        }
+    }
+
+    auto tree = BTree<std::uint64_t, std::uint64_t>{};
+    std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::flush;
+    CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+    std::cout << "done" << std::endl;
+
+    for (const auto is_cached: {false, true}) {
+        for (const auto *workload: {&read_only, &read_mostly}) {
+            auto cache = std::make_unique<HotKeyCache<std::uint64_t, std::uint64_t>>(cache_capacity);
+            tree.hot_key_cache = is_cached ? cache.get() : nullptr;
+
+            std::cout << "Executing " << workload->size() << (workload == &read_only ? " lookup" : " lookup/update (5%)")
+                      << " requests " << (is_cached ? "with" : "without") << " hot-key cache..." << std::flush;
+            const auto start_timestamp = std::chrono::steady_clock::now();
+            CoroutineRoundRobinExecutor::execute(tree, *workload);
+            const auto end_timestamp = std::chrono::steady_clock::now();
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+
+            std::cout << "done (" << double(workload->size()) / (double(ms) / 1000.) << " requests/s";
+            if (is_cached) {
+                std::cout << ", hit ratio " << double(cache->count_hits()) / double(cache->count_hits() + cache->count_misses());
+            }
+            std::cout << ")" << std::endl;
+
+            tree.hot_key_cache = nullptr;
+        }
+    }
+
+    return 0;
+}
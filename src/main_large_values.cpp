@@ -0,0 +1,46 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include <array>
+#include <chrono>
+
+/**
+ * Value of 128 bytes; too large to be stored inside the 256 byte leaves.
+ */
+struct LargeValue {
+    std::array<std::int64_t, 16U> data;
+
+    LargeValue() noexcept = default;
+
+    LargeValue(const std::int64_t value) noexcept { data.fill(value); }
+};
+
+int main() {
+    auto tree = BTree<std::uint64_t, LargeValue>{};
+    static_assert(decltype(tree)::is_out_of_line_values);
+
+    /// Create the workload.
+    constexpr auto insert_requests = 5000000ULL;
+    constexpr auto lookup_requests = 5000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+
+    std::cout << "large values demo: " << sizeof(LargeValue) << " byte values stored out-of-line, "
+              << decltype(tree)::Leaf::maxEntries << " entries per leaf." << std::endl;
+
+    /// Execute the insert_requests phase.
+    std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::flush;
+    auto start_timestamp = std::chrono::steady_clock::now();
+    CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+    auto end_timestamp = std::chrono::steady_clock::now();
+    const auto insert_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+    std::cout << "done (" << double(insert_requests) / (double(insert_ms) / 1000.) << " inserts/s)" << std::endl;
+
+    /// Execute the lookup phase; each lookup suspends once more to prefetch the value.
+    std::cout << "\nExecuting " << lookup_requests << " lookup requests..." << std::flush;
+    start_timestamp = std::chrono::steady_clock::now();
+    CoroutineRoundRobinExecutor::execute(tree, benchmark_set.mixed_requests());
+    end_timestamp = std::chrono::steady_clock::now();
+    const auto lookup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+    std::cout << "done (" << double(lookup_requests) / (double(lookup_ms) / 1000.) << " lookups/s)" << std::endl;
+    return 0;
+}
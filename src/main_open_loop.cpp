@@ -0,0 +1,53 @@
+#include <iostream>
+#include <iomanip>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include "coroutine/coroutine_async_executor.h"
+#include "workload/open_loop_generator.h"
+
+int main() {
+    /// Create the workload.
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto lookup_requests = 50000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+
+    /// The sweep starts at this rate (requests per second) and increases it by the factor until the tree saturates.
+    constexpr auto start_rate = 250000.;
+    constexpr auto rate_factor = 1.5;
+
+    /// Every rate is offered for about one second.
+    constexpr auto seconds_per_rate = 1.;
+
+    constexpr auto arrival_process = ArrivalProcess::Poisson;
+
+    auto tree = BTree<std::uint64_t, std::uint64_t>{};
+
+    /// Execute the insert_requests phase.
+    std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::flush;
+    CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+    std::cout << "done." << std::endl;
+
+    /// Sweep the arrival rate of lookups.
+    std::cout << "Offering lookups (" << OpenLoopGenerator::to_string(arrival_process) << " arrivals)..." << std::endl;
+    std::cout << std::setw(12) << "offered/s" << std::setw(12) << "achieved/s" << std::setw(12) << "p50 [us]"
+              << std::setw(12) << "p99 [us]" << std::setw(12) << "p99.9 [us]" << std::setw(12) << "max [us]" << std::endl;
+
+    auto executor = CoroutineAsyncExecutor<BTree<std::uint64_t, std::uint64_t>>{tree};
+    const auto generator = OpenLoopGenerator{arrival_process};
+    const auto to_us = [](const std::chrono::nanoseconds latency) { return double(latency.count()) / 1000.; };
+    for (auto rate = start_rate;; rate *= rate_factor) {
+        const auto result = generator.run(executor, benchmark_set.mixed_requests(), rate,
+                                          std::uint64_t(rate * seconds_per_rate));
+        std::cout << std::setw(12) << std::uint64_t(result.offered_rate) << std::setw(12)
+                  << std::uint64_t(result.achieved_rate) << std::setw(12) << to_us(result.p50) << std::setw(12)
+                  << to_us(result.p99) << std::setw(12) << to_us(result.p999) << std::setw(12) << to_us(result.max)
+                  << std::endl;
+
+        if (result.is_saturated()) {
+            std::cout << "Saturated at " << std::uint64_t(result.achieved_rate) << " lookups/s." << std::endl;
+            break;
+        }
+    }
+
+    return 0;
+}
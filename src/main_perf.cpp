@@ -6,20 +6,32 @@
 #include <chrono>
 #include <filesystem>
 
-int main() {
-    auto tree = BTree<std::uint64_t, std::uint64_t>{};
+int main(const int count_arguments, char **arguments) {
+    /// Optional snapshot file: The tree is restored from the file if it exists, otherwise written after inserting.
+    const auto snapshot_file = count_arguments > 1 ? std::string{arguments[1]} : std::string{};
+    const auto is_restore_snapshot = snapshot_file.empty() == false && std::filesystem::exists(snapshot_file);
+    auto tree = is_restore_snapshot ? BTree<std::uint64_t, std::uint64_t>{snapshot_file, SnapshotMode::CopyOnWrite}
+                                    : BTree<std::uint64_t, std::uint64_t>{};
 
     /// Create the workload.
     constexpr auto insert_requests = 5000000ULL;
     constexpr auto lookup_requests = 5000000ULL;
-    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+    auto benchmark_set = NumericWorkloadSet{is_restore_snapshot ? 0ULL : insert_requests, lookup_requests};
 
     std::cout << "perf demo: This demo has less elements in btree!" << std::endl;
     
     /// Execute the insert_requests phase.
-    std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::flush;
-    CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
-    std::cout << "done" << std::endl;
+    if (is_restore_snapshot) {
+        std::cout << "Restored tree from snapshot '" << snapshot_file << "'." << std::endl;
+    } else {
+        std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::flush;
+        CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+        std::cout << "done" << std::endl;
+
+        if (snapshot_file.empty() == false && tree.save_snapshot(snapshot_file)) {
+            std::cout << "Wrote snapshot '" << snapshot_file << "'." << std::endl;
+        }
+    }
 
     /// Execute the lookup phase.
     std::cout << "\nExecuting " << lookup_requests << " lookup requests..." << std::flush;
@@ -3,7 +3,9 @@
 #include "btree_olc.h"
 #include "coroutine/coroutine_round_robin_executor.h"
 #include "system.h"
+#include "level_breakdown.h"
 #include <perfcpp/sampler.h>
+#include <perfcpp/event_counter.h>
 #include <perfcpp/hardware_info.h>
 #include <perfcpp/analyzer/memory_access.h>
 #include <sstream>
@@ -11,16 +13,52 @@
 #include <chrono>
 #include <filesystem>
 
-int main() {
-    auto tree = BTree<std::uint64_t, std::uint64_t>{};
+int main(const int count_arguments, char **arguments) {
+    /// Optional snapshot file: The tree is restored from the file if it exists, otherwise written after inserting.
+    const auto snapshot_file = count_arguments > 1 ? std::string{arguments[1]} : std::string{};
+    const auto is_restore_snapshot = snapshot_file.empty() == false && std::filesystem::exists(snapshot_file);
 
     /// Create the workload.
     constexpr auto insert_requests = 50000000ULL;
     constexpr auto lookup_requests = 50000000ULL;
-    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+    auto benchmark_set = NumericWorkloadSet{is_restore_snapshot ? 0ULL : insert_requests, lookup_requests};
 
-    /// Create performance sampler.
     auto counter_definition = perf::CounterDefinition{};
+
+    /// Baseline: Nodes backed by 4 KiB pages, measuring only throughput and dTLB misses of the lookup phase.
+    /// A restored snapshot lives in the page cache, the baseline is skipped in that case.
+    auto baseline_lookup_throughput = 0.;
+    auto baseline_dtlb_load_misses = 0.;
+    if (is_restore_snapshot == false) {
+        auto tree = BTree<std::uint64_t, std::uint64_t>{HugePageMode::Disabled};
+        std::cout << "Executing " << insert_requests << " insert_requests requests (4KiB pages)..." << std::flush;
+        CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+        std::cout << "done" << std::endl;
+
+        auto event_counter = perf::EventCounter{counter_definition};
+        event_counter.add("dTLB-load-misses");
+
+        std::cout << "Executing " << lookup_requests << " lookup requests (4KiB pages)..." << std::flush;
+        event_counter.start();
+        const auto start_timestamp = std::chrono::steady_clock::now();
+        CoroutineRoundRobinExecutor::execute(tree, benchmark_set.mixed_requests());
+        const auto end_timestamp = std::chrono::steady_clock::now();
+        event_counter.stop();
+        std::cout << "done" << std::endl;
+
+        const auto lookup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                end_timestamp - start_timestamp).count();
+        baseline_lookup_throughput = double(lookup_requests) / (double(lookup_ms) / 1000.);
+        baseline_dtlb_load_misses = event_counter.result(lookup_requests).get("dTLB-load-misses").value_or(0.);
+        std::cout << "lookup-throughput: " << baseline_lookup_throughput
+                  << " / dTLB-load-misses/op: " << baseline_dtlb_load_misses << "\n" << std::endl;
+    }
+
+    /// The tree that is sampled: Nodes backed by (transparent) huge pages.
+    auto tree = is_restore_snapshot ? BTree<std::uint64_t, std::uint64_t>{snapshot_file, SnapshotMode::CopyOnWrite}
+                                    : BTree<std::uint64_t, std::uint64_t>{HugePageMode::Transparent};
+
+    /// Create performance sampler.
     auto config = perf::SampleConfig{};
 
     auto sampler = perf::Sampler{counter_definition, config};
@@ -35,18 +73,32 @@ int main() {
     }
     sampler.values().logical_memory_address(true).latency(true).data_src(true);
 
+    auto event_counter = perf::EventCounter{counter_definition};
+    event_counter.add("dTLB-load-misses");
+
     /// Execute the insert_requests phase.
-    std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::endl;
-    CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
-    std::cout << "done" << std::endl;
+    if (is_restore_snapshot) {
+        std::cout << "Restored tree from snapshot '" << snapshot_file << "'." << std::endl;
+    } else {
+        std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::endl;
+        CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+        std::cout << "done (node memory backed by " << NodeAllocator::to_string(tree.node_allocator.effective_mode())
+                  << ")" << std::endl;
+
+        if (snapshot_file.empty() == false && tree.save_snapshot(snapshot_file)) {
+            std::cout << "Wrote snapshot '" << snapshot_file << "'." << std::endl;
+        }
+    }
 
     /// Execute the lookup phase.
     std::cout << "\nExecuting " << lookup_requests << " lookup requests..." << std::flush;
+    event_counter.start();
     sampler.start();
     const auto start_timestamp = std::chrono::steady_clock::now();
     CoroutineRoundRobinExecutor::execute(tree, benchmark_set.mixed_requests());
     const auto end_timestamp = std::chrono::steady_clock::now();
     sampler.stop();
+    event_counter.stop();
     std::cout << "done" << std::endl;
 
     /// Analyze samples.
@@ -61,19 +113,41 @@ int main() {
     tree.traverse_tree_and_add_nodes(memory_analyzer);
 
     /// (3) Combine nodes and samples.
-    auto result = memory_analyzer.map(sampler.result());
+    const auto samples = sampler.result();
+    auto result = memory_analyzer.map(samples);
     std::cout << result.to_string() << std::endl;
 
+    /// (4) Break the samples down by tree level.
+    auto level_breakdown = LevelBreakdown{tree};
+    level_breakdown.add(samples);
+    std::cout << "Loads per tree level (latency in cycles, data sources and hidden as fraction of samples):\n"
+              << level_breakdown.to_string() << std::endl;
+
+    /// (5) Memory footprint and fill of the tree.
+    const auto tree_statistics = tree.statistics();
+    std::cout << "Tree (fill as fraction of node capacity):\n" << tree_statistics.to_string() << std::endl;
+
     /// Process results and enrich data with metadata from the system and dump to file that will be uploaded via Sciebo.
     const auto lookup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
             end_timestamp - start_timestamp).count();
     const auto lookup_throughput = double(lookup_requests) / (double(lookup_ms) / 1000.);
+    const auto dtlb_load_misses = event_counter.result(lookup_requests).get("dTLB-load-misses").value_or(0.);
+    std::cout << "lookup-throughput: " << lookup_throughput << " (4KiB pages: " << baseline_lookup_throughput
+              << ") / dTLB-load-misses/op: " << dtlb_load_misses << " (4KiB pages: " << baseline_dtlb_load_misses
+              << ")" << std::endl;
+
     auto json_stream = std::stringstream{};
     json_stream
             << "{ \"metadata\":"
             << "{ \"cpu-model-name\": \"" << System::cpu_model_name() << "\", \"cpu-max-mhz\": "
-            << System::cpu_max_mhz() << "}, "
-            << "\"lookup-throughput\": " << lookup_throughput << ", \"results\": " << result.to_json() << "}"
+            << System::cpu_max_mhz() << ", \"node-memory\": \""
+            << (is_restore_snapshot ? "snapshot" : NodeAllocator::to_string(tree.node_allocator.effective_mode()))
+            << "\"}, "
+            << "\"lookup-throughput\": " << lookup_throughput << ", \"dtlb-load-misses\": " << dtlb_load_misses
+            << ", \"baseline-4kib\": { \"lookup-throughput\": " << baseline_lookup_throughput
+            << ", \"dtlb-load-misses\": " << baseline_dtlb_load_misses << "}"
+            << ", \"results\": " << result.to_json() << ", \"levels\": " << level_breakdown.to_json()
+            << ", \"tree\": " << tree_statistics.to_json() << "}"
             << std::flush;
     {
         std::filesystem::create_directory("tutorial-result");
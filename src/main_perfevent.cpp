@@ -1,43 +1,51 @@
 #include <iostream>
 #include "btree_olc.h"
 #include "coroutine/coroutine_round_robin_executor.h"
+#include "perf_event_counters.h"
 #include <sstream>
 #include <fstream>
 #include <chrono>
 #include <filesystem>
 
-#include "PerfEvent.hpp"
-
 int main() {
-    auto tree = BTree<std::uint64_t, std::uint64_t>{};
-
     /// Create the workload.
     constexpr auto insert_requests = 50000000ULL;
     constexpr auto lookup_requests = 50000000ULL;
     auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
-    
-    /// Execute the insert_requests phase.
-    std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::endl;
-    {
-        PerfEvent e;
-        e.startCounters();
-        CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
-        e.stopCounters();
-        e.printReport(std::cout, insert_requests); // use insert_requests as scale factor
-    }
-    std::cout << "done" << std::endl;
 
-    /// Execute the lookup phase.
-    std::cout << "\nExecuting " << lookup_requests << " lookup requests..." << std::endl;
-    const auto start_timestamp = std::chrono::steady_clock::now();
-    {
-        PerfEvent e;
-        e.startCounters();
-        CoroutineRoundRobinExecutor::execute(tree, benchmark_set.mixed_requests());
-        e.stopCounters();
-        e.printReport(std::cout, lookup_requests); // use lookup_requests as scale factor
+    /// Run the benchmark with 4 KiB pages and with huge pages backing the nodes to see the effect of dTLB misses.
+    for (const auto huge_page_mode: {HugePageMode::Disabled, HugePageMode::Transparent}) {
+        auto tree = BTree<std::uint64_t, std::uint64_t>{huge_page_mode};
+        std::cout << "\n=== Node memory: " << NodeAllocator::to_string(huge_page_mode) << " ===" << std::endl;
+
+        /// Execute the insert_requests phase.
+        std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::endl;
+        {
+            PerfEvent e;
+            PerfEventCounters::add_dtlb_load_misses(e); // reported per op next to the default counters
+            e.startCounters();
+            CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+            e.stopCounters();
+            e.printReport(std::cout, insert_requests); // use insert_requests as scale factor
+        }
+        std::cout << "done (node memory backed by " << NodeAllocator::to_string(tree.node_allocator.effective_mode())
+                  << ")" << std::endl;
+
+        /// Execute the lookup phase.
+        std::cout << "\nExecuting " << lookup_requests << " lookup requests..." << std::endl;
+        const auto start_timestamp = std::chrono::steady_clock::now();
+        {
+            PerfEvent e;
+            PerfEventCounters::add_dtlb_load_misses(e); // reported per op next to the default counters
+            e.startCounters();
+            CoroutineRoundRobinExecutor::execute(tree, benchmark_set.mixed_requests());
+            e.stopCounters();
+            e.printReport(std::cout, lookup_requests); // use lookup_requests as scale factor
+        }
+        const auto end_timestamp = std::chrono::steady_clock::now();
+        const auto lookup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+        std::cout << "done (" << double(lookup_requests) / (double(lookup_ms) / 1000.) << " lookups/s)" << std::endl;
     }
-    const auto end_timestamp = std::chrono::steady_clock::now();
-    std::cout << "done" << std::endl;
+
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+/**
+ * How read views are used while executing the point operations.
+ */
+enum class ViewMode : std::uint8_t {
+    /// No view is open: Writers only check that no view is open.
+    None = 0U,
+
+    /// One view is open during the whole phase: The first write to every leaf copies the leaf.
+    Open = 1U,
+
+    /// Another thread repeatedly opens a view, scans a range in the view, and closes the view.
+    ScanningReader = 2U
+};
+
+int main() {
+    /// Create the workload.
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto mixed_requests = 50000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, 0U};
+
+    /// Entries read by every scan of the concurrent reader.
+    constexpr auto scan_length = 100000ULL;
+
+    /// Point operations: 50% lookups, 50% updates of uniformly chosen keys.
+    auto random = std::mt19937_64{1337U};
+    auto mixed = std::vector<NumericTuple>{};
+    mixed.reserve(mixed_requests);
+    for (auto i = 0ULL; i < mixed_requests; ++i) {
+        const auto key = random() % insert_requests;
+        if (random() % 2U == 0U) {
+            mixed.emplace_back(NumericTuple::Type::LOOKUP, key);
+        } else {
+            mixed.emplace_back(NumericTuple::Type::UPDATE, key, std::int64_t(i));
+        }
+    }
+
+    for (const auto mode: {ViewMode::None, ViewMode::Open, ViewMode::ScanningReader}) {
+        auto tree = BTree<std::uint64_t, std::uint64_t>{};
+        std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::flush;
+        CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+        std::cout << "done" << std::endl;
+
+        auto view = ReadView{};
+        if (mode == ViewMode::Open) {
+            view = tree.open_read_view();
+        }
+
+        /// Scans in views, concurrently to the point operations.
+        auto is_running = std::atomic<bool>{true};
+        auto count_scans = std::atomic<std::uint64_t>{0U};
+        auto reader = std::thread{};
+        if (mode == ViewMode::ScanningReader) {
+            reader = std::thread{[&tree, &is_running, &count_scans]() {
+                auto scan_random = std::mt19937_64{42U};
+                while (is_running.load(std::memory_order_relaxed)) {
+                    const auto scan_view = tree.open_read_view();
+                    auto value = std::uint64_t{0U};
+                    auto scan = tree.scan(scan_view, scan_random() % insert_requests, scan_length, value);
+                    while (scan.is_done() == false) {
+                        scan.resume();
+                    }
+                    scan.destroy();
+                    tree.close_read_view(scan_view);
+                    count_scans.fetch_add(1U, std::memory_order_relaxed);
+                }
+            }};
+        }
+
+        const auto name = mode == ViewMode::None ? "no view" : (mode == ViewMode::Open ? "an open view"
+                                                                                       : "a scanning reader");
+        std::cout << "Executing " << mixed_requests << " lookup/update requests with " << name << "..." << std::flush;
+        const auto start_timestamp = std::chrono::steady_clock::now();
+        CoroutineRoundRobinExecutor::execute(tree, mixed);
+        const auto end_timestamp = std::chrono::steady_clock::now();
+        const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+
+        is_running.store(false);
+        if (reader.joinable()) {
+            reader.join();
+        }
+
+        std::cout << "done (" << double(mixed_requests) / (double(ms) / 1000.) << " requests/s";
+        if (mode == ViewMode::Open) {
+            const auto count_versions = tree.leaf_versions.count_versions();
+            std::cout << ", " << count_versions << " leaf images ("
+                      << double(count_versions * sizeof(LeafVersions<decltype(tree)::Leaf>::Version)) / (1024. * 1024.)
+                      << " MiB)";
+            tree.close_read_view(view);
+        } else if (mode == ViewMode::ScanningReader) {
+            std::cout << ", " << count_scans.load() << " scans of " << scan_length << " entries in views";
+        }
+        std::cout << ")" << std::endl;
+    }
+
+    return 0;
+}
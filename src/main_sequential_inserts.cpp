@@ -0,0 +1,68 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+/**
+ * Inserts the keys with the given split policy and reports the fill of the tree and the lookup throughput.
+ */
+void run(const std::string &name, const SplitPolicy split_policy, const std::vector<NumericTuple> &insert_requests,
+         const std::vector<NumericTuple> &lookup_requests) {
+    auto tree = BTree<std::uint64_t, std::uint64_t>{};
+    tree.split_policy = split_policy;
+
+    std::cout << name << " (" << (split_policy == SplitPolicy::Adaptive ? "adaptive" : "midpoint") << " split)"
+              << std::endl;
+    std::cout << "  Executing " << insert_requests.size() << " insert requests..." << std::flush;
+    CoroutineRoundRobinExecutor::execute(tree, insert_requests);
+    const auto statistics = tree.statistics();
+    std::cout << "done (height " << statistics.height() << ", leaf fill " << statistics.levels.back().average_fill()
+              << ", " << statistics.allocated_bytes / (1024. * 1024.) << " MiB of nodes)" << std::endl;
+
+    std::cout << "  Executing " << lookup_requests.size() << " lookup requests..." << std::flush;
+    const auto start_timestamp = std::chrono::steady_clock::now();
+    CoroutineRoundRobinExecutor::execute(tree, lookup_requests);
+    const auto end_timestamp = std::chrono::steady_clock::now();
+    const auto lookup_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+    std::cout << "done (" << double(lookup_requests.size()) / (double(lookup_ms) / 1000.) << " lookups/s)" << std::endl;
+}
+
+int main() {
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto lookup_requests = 50000000ULL;
+
+    auto random = std::mt19937_64{1337U};
+
+    /// Monotonic keys, e.g., an auto-increment column.
+    auto sequential = std::vector<NumericTuple>{};
+    sequential.reserve(insert_requests);
+    for (auto i = 0ULL; i < insert_requests; ++i) {
+        sequential.emplace_back(NumericTuple::Type::INSERT, i, std::int64_t(i));
+    }
+
+    /// Time-ordered keys: Increasing, but shuffled within blocks of 8 keys (events arriving slightly out of order).
+    auto time_ordered = sequential;
+    for (auto i = 0ULL; i < insert_requests; i += 8U) {
+        std::shuffle(time_ordered.begin() + i, time_ordered.begin() + std::min(insert_requests, i + 8U), random);
+    }
+
+    /// Random keys, as a reference for the midpoint split.
+    auto shuffled = sequential;
+    std::shuffle(shuffled.begin(), shuffled.end(), random);
+
+    auto lookups = std::vector<NumericTuple>{};
+    lookups.reserve(lookup_requests);
+    for (auto i = 0ULL; i < lookup_requests; ++i) {
+        lookups.emplace_back(NumericTuple::Type::LOOKUP, random() % insert_requests);
+    }
+
+    for (const auto split_policy: {SplitPolicy::Midpoint, SplitPolicy::Adaptive}) {
+        run("Sequential keys", split_policy, sequential, lookups);
+        run("Time-ordered keys", split_policy, time_ordered, lookups);
+        run("Random keys", split_policy, shuffled, lookups);
+    }
+
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "sharded_tree.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include "coroutine/coroutine_async_executor.h"
+#include "workload/zipf_distribution.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+/// Threads that submit requests, and the number of requests each client awaits at once.
+constexpr auto count_clients = 4U;
+constexpr auto outstanding_requests = 64U;
+
+/**
+ * Submits all requests from the client threads.
+ *
+ * @param submit Callable that submits a request and returns its future.
+ * @param requests Requests.
+ * @return Requests per second.
+ */
+template<typename F>
+double submit_all(F &&submit, const std::vector<NumericTuple> &requests) {
+    const auto start_timestamp = std::chrono::steady_clock::now();
+    auto clients = std::vector<std::thread>{};
+    for (auto client_id = 0U; client_id < count_clients; ++client_id) {
+        clients.emplace_back([&, client_id] {
+            auto futures = std::vector<std::future<std::uint64_t>>{};
+            futures.reserve(outstanding_requests);
+            for (auto index = std::uint64_t(client_id); index < requests.size(); index += count_clients) {
+                futures.emplace_back(submit(index, requests[index]));
+                if (futures.size() == outstanding_requests) {
+                    for (auto &future: futures) {
+                        future.wait();
+                    }
+                    futures.clear();
+                }
+            }
+            for (auto &future: futures) {
+                future.wait();
+            }
+        });
+    }
+    for (auto &client: clients) {
+        client.join();
+    }
+    const auto end_timestamp = std::chrono::steady_clock::now();
+    return double(requests.size()) / std::chrono::duration<double>(end_timestamp - start_timestamp).count();
+}
+
+void print_load(const ShardedTree<std::uint64_t, std::uint64_t> &tree) {
+    auto count_requests = std::uint64_t{0U};
+    for (auto shard_id = 0U; shard_id < tree.count_shards(); ++shard_id) {
+        count_requests += tree.count_requests(shard_id);
+    }
+    std::cout << "    load per shard:";
+    for (auto shard_id = 0U; shard_id < tree.count_shards(); ++shard_id) {
+        std::cout << " " << 100. * double(tree.count_requests(shard_id)) / double(std::max<std::uint64_t>(1U, count_requests))
+                  << "%";
+    }
+    std::cout << std::endl;
+}
+
+int main() {
+    /// Create the workload.
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto lookup_requests = 10000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+
+    /// Skewed lookups: Zipf ranks are used as keys (not scattered), so that the hot keys fall into the first shard.
+    auto random = std::mt19937_64{1337U};
+    auto zipf = ZipfDistribution{insert_requests};
+    auto skewed_requests = std::vector<NumericTuple>{};
+    skewed_requests.reserve(lookup_requests);
+    for (auto i = 0ULL; i < lookup_requests; ++i) {
+        skewed_requests.emplace_back(NumericTuple::Type::LOOKUP, zipf(random));
+    }
+
+    const auto max_workers = std::max(1U, std::thread::hardware_concurrency());
+    for (auto count_workers = 1U; count_workers <= max_workers; count_workers *= 2U) {
+        std::cout << "\n" << count_workers << " worker(s)" << std::endl;
+
+        /// Shared tree: All workers execute requests on one tree, requests are distributed round-robin.
+        {
+            auto tree = BTree<std::uint64_t, std::uint64_t>{};
+            CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+
+            auto executors = std::vector<std::unique_ptr<CoroutineAsyncExecutor<BTree<std::uint64_t, std::uint64_t>>>>{};
+            for (auto worker_id = 0U; worker_id < count_workers; ++worker_id) {
+                executors.emplace_back(std::make_unique<CoroutineAsyncExecutor<BTree<std::uint64_t, std::uint64_t>>>(
+                        tree, MachineProfile::current().parallel_coroutines, std::int32_t(worker_id)));
+            }
+            const auto submit = [&executors](const std::uint64_t index, const NumericTuple &request) {
+                return executors[index % executors.size()]->submit(request);
+            };
+
+            std::cout << "  shared tree:  " << submit_all(submit, benchmark_set.mixed_requests())
+                      << " uniform lookups/s, " << submit_all(submit, skewed_requests) << " skewed lookups/s"
+                      << std::endl;
+        }
+
+        /// Sharded tree: Every worker owns a key range.
+        {
+            auto tree = ShardedTree<std::uint64_t, std::uint64_t>{std::uint16_t(count_workers), insert_requests};
+            const auto submit = [&tree](const std::uint64_t, const NumericTuple &request) {
+                return tree.submit(request);
+            };
+            submit_all(submit, benchmark_set.insert_requests());
+
+            std::cout << "  sharded tree: " << submit_all(submit, benchmark_set.mixed_requests())
+                      << " uniform lookups/s" << std::endl;
+            print_load(tree);
+
+            /// Count (and sample) the requests of the skewed workload only.
+            tree.reset_count_requests();
+            std::cout << "  sharded tree: " << submit_all(submit, skewed_requests) << " skewed lookups/s" << std::endl;
+            print_load(tree);
+
+            const auto is_rebalanced = tree.rebalance();
+            std::cout << "  sharded tree: " << submit_all(submit, skewed_requests) << " skewed lookups/s after "
+                      << (is_rebalanced ? "rebalancing" : "no rebalancing (balanced)") << std::endl;
+            print_load(tree);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,38 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include "counter_timeline.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+
+int main() {
+    /// Create the workload.
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto lookup_requests = 50000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+
+    /// Time between two counter snapshots.
+    constexpr auto interval = std::chrono::milliseconds{100U};
+
+    auto tree = BTree<std::uint64_t, std::uint64_t>{};
+    std::filesystem::create_directory("tutorial-result");
+
+    /// Execute both phases, taking snapshots in the background.
+    for (const auto phase: {phase::INSERT, phase::MIXED}) {
+        const auto name = std::string{phase == phase::INSERT ? "insert" : "lookup"};
+        std::cout << "Executing " << benchmark_set[phase].size() << " " << name << " requests..." << std::flush;
+
+        auto timeline = CounterTimeline{interval};
+        timeline.start();
+        CoroutineRoundRobinExecutor::execute(tree, benchmark_set[phase], &timeline.count_completed());
+        timeline.stop();
+        std::cout << "done (" << timeline.snapshots().size() << " snapshots)" << std::endl;
+
+        timeline.write_csv(std::cout);
+        auto out_stream = std::ofstream{std::string{"tutorial-result/timeline-"}.append(name).append(".csv")};
+        timeline.write_csv(out_stream);
+    }
+
+    return 0;
+}
@@ -0,0 +1,50 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include "coroutine/coroutine_trace.h"
+#include <chrono>
+#include <string>
+
+int main(const int count_arguments, char **arguments) {
+    /// File the trace is written to; open in chrome://tracing or https://ui.perfetto.dev.
+    const auto trace_file = count_arguments > 1 ? std::string{arguments[1]} : std::string{"coroutine-trace.json"};
+
+    /// Create the workload.
+    constexpr auto insert_requests = 50000000ULL;
+    constexpr auto lookup_requests = 10000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+
+    /// Events kept (the last ones of the phase): Around 14 per lookup, i.e., the last ~20k lookups.
+    constexpr auto trace_capacity = 1ULL << 18U;
+
+    auto tree = BTree<std::uint64_t, std::uint64_t>{};
+    std::cout << "Executing " << insert_requests << " insert_requests requests..." << std::flush;
+    CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+    std::cout << "done" << std::endl;
+
+    /// Once without and once with tracing, to see the overhead of recording.
+    auto trace = CoroutineTrace{trace_capacity};
+    for (const auto is_traced: {false, true}) {
+        std::cout << "Executing " << lookup_requests << " lookup requests" << (is_traced ? " (traced)" : "")
+                  << "..." << std::flush;
+        const auto start_timestamp = std::chrono::steady_clock::now();
+        if (is_traced) {
+            CoroutineRoundRobinExecutor::execute_traced(tree, benchmark_set.mixed_requests(), trace);
+        } else {
+            CoroutineRoundRobinExecutor::execute(tree, benchmark_set.mixed_requests());
+        }
+        const auto end_timestamp = std::chrono::steady_clock::now();
+        std::cout << "done (" << double(lookup_requests) / std::chrono::duration<double>(end_timestamp -
+                                                                                          start_timestamp).count()
+                  << " requests/s)" << std::endl;
+    }
+
+    if (trace.write_chrome_trace(trace_file)) {
+        std::cout << "Wrote the last " << trace_capacity << " events to '" << trace_file << "'." << std::endl;
+    } else {
+        std::cout << "Could not write '" << trace_file << "'." << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
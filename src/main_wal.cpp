@@ -0,0 +1,67 @@
+#include <iostream>
+#include "btree_olc.h"
+#include "coroutine/coroutine_round_robin_executor.h"
+#include "persistence/write_ahead_log.h"
+#include <chrono>
+#include <filesystem>
+
+int main() {
+    using Log = WriteAheadLog<std::uint64_t, std::uint64_t>;
+
+    /// Create the workload.
+    constexpr auto insert_requests = 1000000ULL;
+    constexpr auto lookup_requests = 1000000ULL;
+    auto benchmark_set = NumericWorkloadSet{insert_requests, lookup_requests};
+
+    const auto log_file = std::string{"olc-coro-tree.wal"};
+    std::filesystem::remove(log_file);
+
+    /// (1) Execute the insert_requests phase without logging.
+    auto throughput_without_log = 0.;
+    {
+        auto tree = BTree<std::uint64_t, std::uint64_t>{};
+        std::cout << "Executing " << insert_requests << " insert_requests requests without log..." << std::flush;
+        const auto start_timestamp = std::chrono::steady_clock::now();
+        CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+        const auto end_timestamp = std::chrono::steady_clock::now();
+        const auto insert_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+        throughput_without_log = double(insert_requests) / (double(std::max<std::int64_t>(insert_ms, 1)) / 1000.);
+        std::cout << "done (" << throughput_without_log << " inserts/s)" << std::endl;
+    }
+
+    /// (2) Execute the insert_requests phase with logging; the executor commits once per round.
+    {
+        auto tree = BTree<std::uint64_t, std::uint64_t>{};
+        auto log = Log{log_file};
+        tree.write_ahead_log = &log;
+
+        std::cout << "Executing " << insert_requests << " insert_requests requests with log..." << std::flush;
+        const auto start_timestamp = std::chrono::steady_clock::now();
+        CoroutineRoundRobinExecutor::execute(tree, benchmark_set.insert_requests());
+        const auto end_timestamp = std::chrono::steady_clock::now();
+        const auto insert_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+        const auto throughput_with_log = double(insert_requests) / (double(std::max<std::int64_t>(insert_ms, 1)) / 1000.);
+        std::cout << "done (" << throughput_with_log << " inserts/s, "
+                  << throughput_with_log / throughput_without_log * 100. << "% of unlogged)" << std::endl;
+        std::cout << "  group commits: " << log.count_batches() << " / records per commit: "
+                  << double(log.count_committed_records()) / double(std::max<std::uint64_t>(log.count_batches(), 1U))
+                  << " / log size: " << log.count_bytes() / (1024. * 1024.) << " MiB" << std::endl;
+    }
+
+    /// (3) Recover a tree from the log and execute the lookup phase on it.
+    {
+        auto tree = BTree<std::uint64_t, std::uint64_t>{};
+        std::cout << "\nRecovering from log '" << log_file << "'..." << std::flush;
+        const auto start_timestamp = std::chrono::steady_clock::now();
+        const auto count_replayed = Log::recover(log_file, tree);
+        const auto end_timestamp = std::chrono::steady_clock::now();
+        const auto recovery_ms = std::chrono::duration_cast<std::chrono::milliseconds>(end_timestamp - start_timestamp).count();
+        std::cout << "done (" << count_replayed << " operations in " << recovery_ms << " ms)" << std::endl;
+
+        std::cout << "Executing " << lookup_requests << " lookup requests..." << std::flush;
+        CoroutineRoundRobinExecutor::execute(tree, benchmark_set.mixed_requests());
+        std::cout << "done" << std::endl;
+    }
+
+    return 0;
+}
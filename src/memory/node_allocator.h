@@ -0,0 +1,243 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <sys/mman.h>
+
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+#ifndef MAP_HUGE_2MB
+#define MAP_HUGE_2MB (21 << MAP_HUGE_SHIFT)
+#endif
+#ifndef MAP_HUGE_1GB
+#define MAP_HUGE_1GB (30 << MAP_HUGE_SHIFT)
+#endif
+
+/**
+ * Backing of the memory that holds the tree nodes.
+ */
+enum class HugePageMode : std::uint8_t {
+    /// Regular 4 KiB pages; transparent huge pages are explicitly disabled for the node memory.
+    Disabled = 0U,
+
+    /// Chunks of 2 MiB advised as transparent huge pages (madvise).
+    Transparent = 1U,
+
+    /// Explicit 2 MiB pages from hugetlbfs, falls back to Transparent.
+    Explicit2MB = 2U,
+
+    /// Explicit 1 GiB pages from hugetlbfs, falls back to Explicit2MB.
+    Explicit1GB = 3U
+};
+
+/**
+ * Allocates nodes from large, mmap'ed chunks that can be backed by huge pages.
+ * A 50M-key tree spans gigabytes of memory; with 4 KiB pages every level of the
+ * descent risks a dTLB miss in addition to the cache miss hidden by the coroutine.
+ *
+ * Nodes are never freed individually; all chunks are released when the allocator is destroyed.
+ * Threads allocate from the current chunk by an atomic bump pointer; mapping a new chunk is serialized.
+ * The statistics accessors take the same lock, so they may be called while other threads allocate.
+ */
+class NodeAllocator {
+public:
+    explicit NodeAllocator(const HugePageMode mode = HugePageMode::Transparent) noexcept : _mode(mode) {}
+
+    NodeAllocator(const NodeAllocator &) = delete;
+
+    NodeAllocator &operator=(const NodeAllocator &) = delete;
+
+    ~NodeAllocator() {
+        for (const auto &chunk: _chunks) {
+            ::munmap(chunk.first, chunk.second);
+        }
+    }
+
+    /**
+     * Allocates memory for a single node.
+     *
+     * @param size Size of the node.
+     * @param alignment Alignment of the node, must be a power of two.
+     * @return Pointer to the memory.
+     */
+    void *allocate(const std::size_t size, const std::size_t alignment) {
+        while (true) {
+            auto *region = _region.load(std::memory_order_acquire);
+            if (region != nullptr) {
+                auto head = region->head.load(std::memory_order_relaxed);
+                auto begin = (head + alignment - 1U) & ~(alignment - 1U);
+                while (begin + size <= region->end) {
+                    if (region->head.compare_exchange_weak(head, begin + size, std::memory_order_relaxed)) {
+                        return reinterpret_cast<void *>(begin);
+                    }
+                    begin = (head + alignment - 1U) & ~(alignment - 1U);
+                }
+            }
+
+            /// The chunk is exhausted: The first thread maps the next one, the others retry on it.
+            std::lock_guard<std::mutex> lock{_mutex};
+            if (_region.load(std::memory_order_relaxed) == region) {
+                allocate_chunk(size + alignment);
+            }
+        }
+    }
+
+    /**
+     * @return The requested backing of the node memory.
+     */
+    [[nodiscard]] HugePageMode mode() const noexcept { return _mode; }
+
+    /**
+     * @return The backing of the node memory after falling back (if explicit huge pages were not available).
+     */
+    [[nodiscard]] HugePageMode effective_mode() const noexcept {
+        return _effective_mode.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return Number of bytes handed out for nodes (including alignment padding).
+     */
+    [[nodiscard]] std::size_t allocated_bytes() const {
+        std::lock_guard<std::mutex> lock{_mutex};
+        auto bytes = std::size_t{0U};
+        for (const auto &region: _regions) {
+            bytes += region.head.load(std::memory_order_relaxed) - region.begin;
+        }
+        return bytes;
+    }
+
+    /**
+     * @return Number of bytes mapped for nodes.
+     */
+    [[nodiscard]] std::size_t mapped_bytes() const {
+        std::lock_guard<std::mutex> lock{_mutex};
+        auto bytes = std::size_t{0U};
+        for (const auto &chunk: _chunks) {
+            bytes += chunk.second;
+        }
+        return bytes;
+    }
+
+    /**
+     * @return Copy of all mapped chunks (begin, size); chunks are not sorted by address.
+     */
+    [[nodiscard]] std::vector<std::pair<void *, std::size_t>> chunks() const {
+        std::lock_guard<std::mutex> lock{_mutex};
+        return _chunks;
+    }
+
+    [[nodiscard]] static const char *to_string(const HugePageMode mode) noexcept {
+        switch (mode) {
+            case HugePageMode::Disabled:
+                return "4KiB";
+            case HugePageMode::Transparent:
+                return "THP";
+            case HugePageMode::Explicit2MB:
+                return "hugetlb-2MiB";
+            case HugePageMode::Explicit1GB:
+                return "hugetlb-1GiB";
+        }
+        return "unknown";
+    }
+
+private:
+    static constexpr std::size_t size_2mb = 1ULL << 21U;
+    static constexpr std::size_t size_1gb = 1ULL << 30U;
+
+    /// Requested backing.
+    const HugePageMode _mode;
+
+    /// Backing that was actually used for the latest chunk.
+    std::atomic<HugePageMode> _effective_mode{HugePageMode::Disabled};
+
+    /// All mapped chunks (begin, size).
+    std::vector<std::pair<void *, std::size_t>> _chunks;
+
+    /**
+     * Unused part of a chunk.
+     */
+    struct Region {
+        Region(const std::uintptr_t begin, const std::uintptr_t end) noexcept : begin(begin), head(begin), end(end) {}
+
+        const std::uintptr_t begin;
+
+        /// Bump pointer.
+        std::atomic<std::uintptr_t> head;
+        const std::uintptr_t end;
+    };
+
+    /// Regions of all chunks; threads may still read a region after the next chunk was mapped.
+    std::deque<Region> _regions;
+
+    /// Region of the current chunk, nodes are allocated from.
+    alignas(64) std::atomic<Region *> _region{nullptr};
+
+    /// Serializes mapping chunks and reading the chunks and regions for statistics.
+    mutable std::mutex _mutex;
+
+    static std::size_t round_up(const std::size_t size, const std::size_t alignment) noexcept {
+        return (size + alignment - 1U) & ~(alignment - 1U);
+    }
+
+    /**
+     * Maps a new chunk of at least the given size, trying the requested backing first and
+     * falling back to smaller pages if explicit huge pages are not reserved on the system.
+     */
+    void allocate_chunk(const std::size_t min_size) {
+        void *chunk = MAP_FAILED;
+        auto size = std::size_t{0U};
+
+        auto mode = _mode;
+        if (mode == HugePageMode::Explicit1GB) {
+            size = round_up(min_size, size_1gb);
+            chunk = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_1GB, -1, 0);
+            if (chunk == MAP_FAILED) {
+                mode = HugePageMode::Explicit2MB;
+            }
+        }
+
+        if (mode == HugePageMode::Explicit2MB) {
+            size = round_up(min_size, size_2mb);
+            chunk = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_HUGE_2MB, -1, 0);
+            if (chunk == MAP_FAILED) {
+                mode = HugePageMode::Transparent;
+            }
+        }
+
+        if (mode == HugePageMode::Transparent || mode == HugePageMode::Disabled) {
+            /// Over-allocate by one huge page so the chunk can be aligned to 2 MiB,
+            /// otherwise the kernel can not back the first and last part with huge pages.
+            size = round_up(std::max(min_size, std::size_t{16U} * size_2mb), size_2mb);
+            auto *memory = ::mmap(nullptr, size + size_2mb, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (memory == MAP_FAILED) {
+                throw std::bad_alloc{};
+            }
+
+            const auto begin = round_up(std::uintptr_t(memory), size_2mb);
+            const auto front = begin - std::uintptr_t(memory);
+            if (front > 0U) {
+                ::munmap(memory, front);
+            }
+            if (size_2mb - front > 0U) {
+                ::munmap(reinterpret_cast<void *>(begin + size), size_2mb - front);
+            }
+            chunk = reinterpret_cast<void *>(begin);
+
+            ::madvise(chunk, size, mode == HugePageMode::Transparent ? MADV_HUGEPAGE : MADV_NOHUGEPAGE);
+        }
+
+        _effective_mode.store(mode, std::memory_order_relaxed);
+        _chunks.emplace_back(chunk, size);
+        _region.store(&_regions.emplace_back(std::uintptr_t(chunk), std::uintptr_t(chunk) + size),
+                      std::memory_order_release);
+    }
+};
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "node_allocator.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+/**
+ * Compact (32bit) reference to a value stored out-of-line in the ValueHeap.
+ */
+using ValueHandle = std::uint32_t;
+
+/**
+ * Trait deciding whether values are stored out-of-line: Values larger than two words would
+ * destroy the fanout of 256 byte leaves, the leaf holds a ValueHandle instead.
+ */
+template<class Value>
+inline constexpr bool is_out_of_line_value_v = sizeof(Value) > 2U * sizeof(std::uint64_t);
+
+/**
+ * Append-only storage for values that do not fit into the leaves. Values are immutable once
+ * published: An update allocates a new slot and swaps the handle in the leaf (under the leaf lock),
+ * readers that still hold the old handle read the old value. Slots are never reclaimed.
+ *
+ * Slots are organized in chunks of 2^16 values; the table of chunks has a fixed size, so readers
+ * resolve handles without synchronization.
+ */
+template<class Value>
+class ValueHeap {
+    static_assert(std::is_trivially_copyable_v<Value>);
+
+public:
+    static constexpr std::uint32_t slots_per_chunk_bits = 16U;
+    static constexpr std::uint32_t slots_per_chunk = 1U << slots_per_chunk_bits;
+    static constexpr std::uint32_t max_chunks = 1U << (32U - slots_per_chunk_bits);
+
+    explicit ValueHeap(const HugePageMode huge_page_mode = HugePageMode::Transparent) : _chunk_allocator(huge_page_mode) {}
+
+    ValueHeap(const ValueHeap &) = delete;
+
+    ~ValueHeap() = default;
+
+    /**
+     * Stores the value in a new slot.
+     *
+     * @param value Value to store.
+     * @return Handle of the slot.
+     */
+    [[nodiscard]] ValueHandle allocate(const Value &value) {
+        const auto handle = _next_slot.fetch_add(1U);
+        if (handle >= std::uint64_t(max_chunks) * slots_per_chunk) {
+            throw std::bad_alloc{};
+        }
+        const auto chunk_index = handle >> slots_per_chunk_bits;
+
+        /// The first slot of a chunk creates the chunk, all others wait until it is published.
+        auto *chunk = _chunks[chunk_index].load();
+        if (chunk == nullptr) {
+            if ((handle & (slots_per_chunk - 1U)) == 0U) {
+                chunk = static_cast<Value *>(_chunk_allocator.allocate(sizeof(Value) * slots_per_chunk, alignof(Value)));
+                _chunks[chunk_index].store(chunk);
+            } else {
+                while ((chunk = _chunks[chunk_index].load()) == nullptr) {
+                }
+            }
+        }
+
+        new(&chunk[handle & (slots_per_chunk - 1U)]) Value(value);
+        return ValueHandle(handle);
+    }
+
+    /**
+     * @return Pointer to the value stored under the handle.
+     */
+    [[nodiscard]] const Value *get(const ValueHandle handle) const noexcept {
+        return &_chunks[handle >> slots_per_chunk_bits].load(std::memory_order_relaxed)[handle & (slots_per_chunk - 1U)];
+    }
+
+    /**
+     * @return Number of values stored so far (including values replaced by updates).
+     */
+    [[nodiscard]] std::uint64_t size() const noexcept { return _next_slot.load(); }
+
+private:
+    NodeAllocator _chunk_allocator;
+
+    std::atomic<std::uint64_t> _next_slot{0U};
+
+    std::unique_ptr<std::atomic<Value *>[]> _chunks{new std::atomic<Value *>[max_chunks]{}};
+};
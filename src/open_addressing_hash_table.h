@@ -0,0 +1,175 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <type_traits>
+
+/**
+ * Single-threaded hash table with open addressing (linear probing), used as a baseline for the tree.
+ * Removed entries leave tombstones, which are dropped when the table grows.
+ *
+ * @tparam Key Type of the keys.
+ * @tparam Value Type of the values.
+ */
+template<class Key, class Value>
+class OpenAddressingHashTable {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>);
+
+public:
+    /**
+     * @param capacity Number of entries the table holds without growing.
+     */
+    explicit OpenAddressingHashTable(const std::uint64_t capacity = 1024U) { allocate(slots_for(capacity)); }
+
+    OpenAddressingHashTable(const OpenAddressingHashTable &) = delete;
+
+    OpenAddressingHashTable &operator=(const OpenAddressingHashTable &) = delete;
+
+    ~OpenAddressingHashTable() = default;
+
+    /**
+     * Inserts or updates the key.
+     * @return True, if the key was inserted; false, if an existing key was updated.
+     */
+    bool insert(const Key key, const Value value) {
+        if ((_count_entries + _count_tombstones + 1U) * max_load_denominator > _count_slots * max_load_numerator) {
+            grow();
+        }
+
+        auto tombstone = _count_slots;
+        for (auto slot = hash(key) & (_count_slots - 1U);; slot = (slot + 1U) & (_count_slots - 1U)) {
+            if (_states[slot] == State::Full) {
+                if (_keys[slot] == key) {
+                    _values[slot] = value;
+                    return false;
+                }
+            } else if (_states[slot] == State::Tombstone) {
+                tombstone = tombstone == _count_slots ? slot : tombstone;
+            } else {
+                /// Re-use the first tombstone on the probe sequence.
+                if (tombstone != _count_slots) {
+                    slot = tombstone;
+                    --_count_tombstones;
+                }
+                _states[slot] = State::Full;
+                _keys[slot] = key;
+                _values[slot] = value;
+                ++_count_entries;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * @return True, if the key was found.
+     */
+    bool lookup(const Key key, Value &value) const {
+        const auto slot = find(key);
+        if (slot == _count_slots) {
+            return false;
+        }
+        value = _values[slot];
+        return true;
+    }
+
+    /**
+     * @return True, if the key was found.
+     */
+    bool remove(const Key key) {
+        const auto slot = find(key);
+        if (slot == _count_slots) {
+            return false;
+        }
+        _states[slot] = State::Tombstone;
+        --_count_entries;
+        ++_count_tombstones;
+        return true;
+    }
+
+    [[nodiscard]] std::uint64_t size() const noexcept { return _count_entries; }
+
+    /**
+     * @return Bytes of the slots.
+     */
+    [[nodiscard]] std::uint64_t allocated_bytes() const noexcept {
+        return _count_slots * (sizeof(State) + sizeof(Key) + sizeof(Value));
+    }
+
+private:
+    enum class State : std::uint8_t {
+        Empty = 0U,
+        Full = 1U,
+        Tombstone = 2U,
+    };
+
+    /// The table grows when more than 3/4 of the slots are used (by entries or tombstones).
+    static constexpr std::uint64_t max_load_numerator = 3U;
+    static constexpr std::uint64_t max_load_denominator = 4U;
+
+    std::uint64_t _count_slots{0U};
+    std::uint64_t _count_entries{0U};
+    std::uint64_t _count_tombstones{0U};
+    std::unique_ptr<State[]> _states;
+    std::unique_ptr<Key[]> _keys;
+    std::unique_ptr<Value[]> _values;
+
+    /**
+     * @return Hash of the key (murmur3 finalizer); sequential keys are spread over the table.
+     */
+    [[nodiscard]] static std::uint64_t hash(const Key key) noexcept {
+        auto hash = std::uint64_t(std::hash<Key>{}(key));
+        hash ^= hash >> 33U;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 33U;
+        hash *= 0xC4CEB9FE1A85EC53ULL;
+        hash ^= hash >> 33U;
+        return hash;
+    }
+
+    [[nodiscard]] static std::uint64_t slots_for(const std::uint64_t capacity) noexcept {
+        return std::bit_ceil(std::max<std::uint64_t>(16U, capacity * max_load_denominator / max_load_numerator + 1U));
+    }
+
+    /**
+     * @return Slot of the key, or the number of slots if the key is not in the table.
+     */
+    [[nodiscard]] std::uint64_t find(const Key key) const noexcept {
+        for (auto slot = hash(key) & (_count_slots - 1U);; slot = (slot + 1U) & (_count_slots - 1U)) {
+            if (_states[slot] == State::Empty) {
+                return _count_slots;
+            }
+            if (_states[slot] == State::Full && _keys[slot] == key) {
+                return slot;
+            }
+        }
+    }
+
+    void allocate(const std::uint64_t count_slots) {
+        _count_slots = count_slots;
+        _count_entries = 0U;
+        _count_tombstones = 0U;
+        _states = std::make_unique<State[]>(count_slots);
+        _keys = std::make_unique_for_overwrite<Key[]>(count_slots);
+        _values = std::make_unique_for_overwrite<Value[]>(count_slots);
+    }
+
+    /**
+     * Re-inserts all entries into a table of twice the size (or the same size, if mostly tombstones).
+     */
+    void grow() {
+        const auto count_slots = _count_slots;
+        auto states = std::move(_states);
+        auto keys = std::move(_keys);
+        auto values = std::move(_values);
+
+        allocate(_count_entries * 2U >= count_slots ? count_slots * 2U : count_slots);
+        for (auto slot = 0ULL; slot < count_slots; ++slot) {
+            if (states[slot] == State::Full) {
+                insert(keys[slot], values[slot]);
+            }
+        }
+    }
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "PerfEvent.hpp"
+
+/**
+ * Additions to the counters of PerfEvent: PerfEvent opens the counters it registers in its constructor,
+ * counters registered later (e.g., dTLB misses) are opened here. Running counters can be read without
+ * stopping them, e.g., from another thread that samples a time series.
+ */
+class PerfEventCounters {
+public:
+    /// Load misses in the data TLB.
+    static constexpr auto dtlb_load_misses = "dTLB-load-misses";
+
+    /**
+     * Registers and opens the counter on the PerfEvent (for the calling thread); must be called before
+     * startCounters().
+     *
+     * @return True, if the counter could be opened (the event exists and access is permitted).
+     */
+    static bool add(PerfEvent &perf_event, const std::string &name, const std::uint64_t type,
+                    const std::uint64_t config) {
+        perf_event.registerCounter(name, type, config);
+
+        auto &event = perf_event.events.back();
+        event.fd = static_cast<int>(::syscall(__NR_perf_event_open, &event.pe, 0, -1, -1, 0));
+        if (event.fd < 0) {
+            perf_event.events.pop_back();
+            perf_event.names.pop_back();
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * Registers and opens the dTLB load miss counter on the PerfEvent.
+     */
+    static bool add_dtlb_load_misses(PerfEvent &perf_event) {
+        return add(perf_event, dtlb_load_misses, PERF_TYPE_HW_CACHE,
+                   PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8U) |
+                   (PERF_COUNT_HW_CACHE_RESULT_MISS << 16U));
+    }
+
+    /**
+     * Reads all counters of the started PerfEvent without stopping them; afterwards, getCounter()
+     * returns the (multiplexing corrected) number of events since startCounters().
+     */
+    static void read(PerfEvent &perf_event) {
+        for (auto &event: perf_event.events) {
+            auto data = event.data;
+            if (::read(event.fd, &data, sizeof(std::uint64_t) * 3U) == sizeof(std::uint64_t) * 3U) {
+                event.data = data;
+            }
+        }
+    }
+};
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * How a snapshot is mapped into memory when the tree is restored.
+ */
+enum class SnapshotMode : std::uint8_t {
+    /// Nodes are mapped read-only from the page cache (and can be shared between processes); the tree supports lookups only.
+    ReadOnly = 0U,
+
+    /// Nodes are mapped private; modified pages are copied on first write and never written back to the file.
+    CopyOnWrite = 1U
+};
+
+/**
+ * Header of a snapshot file. The header occupies the first page of the file, followed by all
+ * inner nodes (breadth-first) and all leaves (in key order). Inner nodes store the file offsets
+ * of their children instead of pointers, which makes the file position-independent.
+ */
+struct SnapshotHeader {
+    /// "OLCTREE3" (version 2: nodes store their height, version 3: the header stores the leaf layout)
+    static constexpr std::uint64_t magic_number = 0x3345455254434C4FULL;
+
+    /// Size of the header on disk; nodes start at the next page boundary.
+    static constexpr std::size_t size = 4096U;
+
+    std::uint64_t magic{magic_number};
+    std::uint32_t page_size{0U};
+    std::uint16_t key_size{0U};
+    std::uint16_t value_size{0U};
+
+    /// LeafLayoutType of the tree; leaves of different layouts are not interchangeable.
+    std::uint8_t leaf_layout{0U};
+    std::uint64_t count_inner_nodes{0U};
+    std::uint64_t count_leaf_nodes{0U};
+    std::uint64_t root_offset{0U};
+
+    [[nodiscard]] std::size_t file_size() const noexcept {
+        return size + (count_inner_nodes + count_leaf_nodes) * page_size;
+    }
+};
+
+/**
+ * Memory mapping of a snapshot file; unmaps the file on destruction.
+ */
+class SnapshotMapping {
+public:
+    SnapshotMapping() noexcept = default;
+
+    SnapshotMapping(const std::string &file_name, const SnapshotMode mode) : _mode(mode) {
+        const auto file_descriptor = ::open(file_name.c_str(), O_RDONLY);
+        if (file_descriptor < 0) {
+            throw std::runtime_error{"Could not open snapshot file '" + file_name + "'."};
+        }
+
+        struct stat file_stat{};
+        if (::fstat(file_descriptor, &file_stat) != 0 || std::size_t(file_stat.st_size) < SnapshotHeader::size) {
+            ::close(file_descriptor);
+            throw std::runtime_error{"Snapshot file '" + file_name + "' is too small."};
+        }
+        _size = std::size_t(file_stat.st_size);
+
+        /// Map private and writable, even for read-only snapshots: The child offsets of inner nodes are
+        /// swizzled into pointers after mapping, which copies only the (few) pages of inner nodes.
+        auto *data = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file_descriptor, 0);
+        ::close(file_descriptor);
+        if (data == MAP_FAILED) {
+            throw std::runtime_error{"Could not map snapshot file '" + file_name + "'."};
+        }
+        _data = static_cast<std::byte *>(data);
+
+        const auto &header = this->header();
+        if (header.magic != SnapshotHeader::magic_number || header.file_size() != _size) {
+            this->unmap();
+            throw std::runtime_error{"File '" + file_name + "' is not a valid snapshot."};
+        }
+    }
+
+    SnapshotMapping(SnapshotMapping &&other) noexcept
+            : _data(std::exchange(other._data, nullptr)), _size(std::exchange(other._size, 0U)), _mode(other._mode) {}
+
+    SnapshotMapping &operator=(SnapshotMapping &&other) noexcept {
+        if (this != &other) {
+            this->unmap();
+            _data = std::exchange(other._data, nullptr);
+            _size = std::exchange(other._size, 0U);
+            _mode = other._mode;
+        }
+        return *this;
+    }
+
+    ~SnapshotMapping() { this->unmap(); }
+
+    [[nodiscard]] const SnapshotHeader &header() const noexcept {
+        return *reinterpret_cast<const SnapshotHeader *>(_data);
+    }
+
+    /**
+     * @return Pointer into the mapped file at the given offset.
+     */
+    [[nodiscard]] std::byte *at(const std::uint64_t offset) const noexcept { return _data + offset; }
+
+    [[nodiscard]] SnapshotMode mode() const noexcept { return _mode; }
+
+    [[nodiscard]] bool is_mapped() const noexcept { return _data != nullptr; }
+
+    /**
+     * @return Size of the mapped file.
+     */
+    [[nodiscard]] std::size_t size() const noexcept { return _size; }
+
+    [[nodiscard]] bool is_writable() const noexcept { return _data == nullptr || _mode == SnapshotMode::CopyOnWrite; }
+
+    /**
+     * Revokes write access to the mapping (for read-only snapshots, once all pointers are swizzled).
+     */
+    void protect() const noexcept { ::mprotect(_data, _size, PROT_READ); }
+
+private:
+    std::byte *_data{nullptr};
+    std::size_t _size{0U};
+    SnapshotMode _mode{SnapshotMode::CopyOnWrite};
+
+    void unmap() noexcept {
+        if (_data != nullptr) {
+            ::munmap(_data, _size);
+            _data = nullptr;
+        }
+    }
+};
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+/**
+ * Append-only log of all modifications of the tree. Operations are appended to an in-memory buffer
+ * (while the leaf is locked, so the log order matches the order in which the tree applied them) and
+ * written with a single write and fdatasync per group commit. The executor commits once per round,
+ * i.e., for all coroutines that modified the tree in that round.
+ *
+ * On disk, the log is a sequence of batches; each batch starts with a header that holds the number of
+ * records and a checksum, so that a batch torn by a crash is detected and ignored on recovery.
+ * A batch that failed to be written is cut off the file and written again (with all operations appended
+ * in between) by the next commit, so that no bytes are logged twice.
+ */
+template<class Key, class Value>
+class WriteAheadLog {
+    static_assert(std::is_trivially_copyable_v<Key> && std::is_trivially_copyable_v<Value>);
+
+public:
+    enum class Operation : std::uint8_t {
+        Insert = 0U,
+        Update = 1U,
+        Remove = 2U
+    };
+
+    struct Record {
+        Operation operation;
+        Key key;
+        Value value;
+    };
+
+    /**
+     * Opens (or creates) the log file and appends to it.
+     *
+     * @param file_name Name of the log file.
+     * @param is_sync If true, each commit waits for the data to be on stable storage (fdatasync).
+     */
+    explicit WriteAheadLog(std::string file_name, const bool is_sync = true)
+            : _file_name(std::move(file_name)), _is_sync(is_sync) {
+        _file_descriptor = ::open(_file_name.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (_file_descriptor < 0) {
+            throw std::runtime_error{"Could not open log file '" + _file_name + "'."};
+        }
+        _count_file_bytes = std::uint64_t(::lseek(_file_descriptor, 0, SEEK_END));
+        _buffer.reserve(1U << 16U);
+        this->begin_batch();
+    }
+
+    WriteAheadLog(const WriteAheadLog &) = delete;
+
+    /**
+     * Commits the pending operations; a failure is reported, since the log is closed anyway.
+     */
+    ~WriteAheadLog() {
+        try {
+            this->commit();
+        } catch (const std::exception &exception) {
+            std::cerr << exception.what() << " Operations of the last batch are lost." << std::endl;
+        }
+        ::close(_file_descriptor);
+    }
+
+    /**
+     * Appends an operation to the current batch; the operation is durable after the next commit().
+     */
+    void append(const Operation operation, const Key key, const Value value) {
+        auto record = Record{};
+        std::memset(&record, 0, sizeof(Record)); /// Padding bytes are part of the checksum.
+        record.operation = operation;
+        record.key = key;
+        record.value = value;
+
+        std::lock_guard<std::mutex> lock{_mutex};
+        const auto offset = _buffer.size();
+        _buffer.resize(offset + sizeof(Record));
+        std::memcpy(_buffer.data() + offset, &record, sizeof(Record));
+        ++_count_pending_records;
+    }
+
+    /**
+     * Writes all pending operations as one batch to the log (group commit). If writing (or syncing) fails,
+     * the operations stay pending and the next commit writes them again.
+     *
+     * @return Number of operations written.
+     */
+    std::uint64_t commit() {
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (_count_pending_records == 0U) {
+            return 0U;
+        }
+
+        /// A failed commit may have left a part of the batch in the file.
+        if (_is_torn) {
+            if (::ftruncate(_file_descriptor, off_t(_count_file_bytes)) != 0) {
+                throw std::runtime_error{"Could not cut the torn batch off log file '" + _file_name + "'."};
+            }
+            _is_torn = false;
+        }
+
+        auto header = BatchHeader{};
+        header.count_records = _count_pending_records;
+        header.checksum = checksum(_buffer.data() + sizeof(BatchHeader), _buffer.size() - sizeof(BatchHeader));
+        std::memcpy(_buffer.data(), &header, sizeof(BatchHeader));
+
+        auto written = std::size_t{0U};
+        while (written < _buffer.size()) {
+            const auto result = ::write(_file_descriptor, _buffer.data() + written, _buffer.size() - written);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                _is_torn = written > 0U;
+                throw std::runtime_error{"Could not write log file '" + _file_name + "'."};
+            }
+            written += std::size_t(result);
+        }
+        if (_is_sync) {
+            auto result = ::fdatasync(_file_descriptor);
+            while (result != 0 && errno == EINTR) {
+                result = ::fdatasync(_file_descriptor);
+            }
+            if (result != 0) {
+                _is_torn = true;
+                throw std::runtime_error{"Could not sync log file '" + _file_name + "'."};
+            }
+        }
+
+        const auto count_records = _count_pending_records;
+        _count_committed_records += count_records;
+        _count_batches += 1U;
+        _count_bytes += _buffer.size();
+        _count_file_bytes += _buffer.size();
+        this->begin_batch();
+
+        return count_records;
+    }
+
+    /**
+     * Discards the log, e.g., after the tree was written to a snapshot.
+     */
+    void truncate() {
+        this->commit();
+        std::lock_guard<std::mutex> lock{_mutex};
+        if (::ftruncate(_file_descriptor, 0) != 0) {
+            throw std::runtime_error{"Could not truncate log file '" + _file_name + "'."};
+        }
+        _count_file_bytes = 0U;
+    }
+
+    [[nodiscard]] std::uint64_t count_committed_records() const noexcept { return _count_committed_records; }
+
+    [[nodiscard]] std::uint64_t count_batches() const noexcept { return _count_batches; }
+
+    [[nodiscard]] std::uint64_t count_bytes() const noexcept { return _count_bytes; }
+
+    /**
+     * Reads all complete batches of the log file and hands each operation (in log order) to the callback.
+     * Reading stops at the first incomplete or corrupt batch (e.g., written while the process crashed).
+     *
+     * @param file_name Name of the log file.
+     * @param callback Callback invoked as callback(operation, key, value).
+     * @return Number of replayed operations.
+     */
+    template<typename F>
+    static std::uint64_t replay(const std::string &file_name, F &&callback) {
+        return read_batches(file_name, std::forward<F>(callback)).first;
+    }
+
+    /**
+     * Replays the log file into the tree; operations are executed one after another to keep the log order.
+     * A torn or corrupt tail is cut off, so that batches appended by the next log follow the last valid one.
+     *
+     * @param file_name Name of the log file.
+     * @param tree Tree to recover; must not have a log attached while recovering.
+     * @return Number of replayed operations.
+     */
+    template<typename T>
+    static std::uint64_t recover(const std::string &file_name, T &tree) {
+        const auto [count_records, valid_bytes] = read_batches(file_name, [&tree](const Operation operation,
+                                                                                const Key key, const Value value) {
+            auto coroutine = operation == Operation::Remove ? tree.remove(key) : tree.insert(key, value);
+            while (coroutine.is_done() == false) {
+                coroutine.resume();
+            }
+            coroutine.destroy();
+        });
+
+        auto file_status = std::error_code{};
+        const auto file_size = std::filesystem::file_size(file_name, file_status);
+        if (file_status.value() == 0 && file_size > valid_bytes &&
+            ::truncate(file_name.c_str(), off_t(valid_bytes)) != 0) {
+            throw std::runtime_error{"Could not truncate log file '" + file_name + "'."};
+        }
+
+        return count_records;
+    }
+
+private:
+    struct BatchHeader {
+        std::uint64_t count_records;
+        std::uint64_t checksum;
+    };
+
+    const std::string _file_name;
+    const bool _is_sync;
+    std::int32_t _file_descriptor;
+
+    /// Batch that is written with the next commit; starts with space for the header.
+    std::vector<char> _buffer;
+    std::uint64_t _count_pending_records{0U};
+
+    /// Size of the file up to the last committed batch, and whether a failed commit left bytes behind it.
+    std::uint64_t _count_file_bytes{0U};
+    bool _is_torn{false};
+
+    std::uint64_t _count_committed_records{0U};
+    std::uint64_t _count_batches{0U};
+    std::uint64_t _count_bytes{0U};
+
+    std::mutex _mutex;
+
+    /**
+     * Hands the operations of all complete batches to the callback.
+     *
+     * @return Number of operations and bytes of the complete batches.
+     */
+    template<typename F>
+    static std::pair<std::uint64_t, std::uint64_t> read_batches(const std::string &file_name, F &&callback) {
+        auto in_stream = std::ifstream{file_name, std::ios::binary | std::ios::ate};
+        const auto file_size = in_stream.is_open() ? std::uint64_t(in_stream.tellg()) : 0ULL;
+        in_stream.seekg(0);
+
+        auto count_records = 0ULL;
+        auto valid_bytes = 0ULL;
+        auto batch = std::vector<char>{};
+
+        auto header = BatchHeader{};
+        while (in_stream.read(reinterpret_cast<char *>(&header), sizeof(BatchHeader))) {
+            /// The header is not covered by the checksum: A torn header must not size the batch beyond the file.
+            const auto remaining_bytes = file_size - valid_bytes - sizeof(BatchHeader);
+            if (header.count_records > remaining_bytes / sizeof(Record)) {
+                break;
+            }
+
+            batch.resize(header.count_records * sizeof(Record));
+            if (!in_stream.read(batch.data(), std::streamsize(batch.size())) ||
+                header.checksum != checksum(batch.data(), batch.size())) {
+                break;
+            }
+
+            for (auto i = 0ULL; i < header.count_records; ++i) {
+                auto record = Record{};
+                std::memcpy(&record, batch.data() + i * sizeof(Record), sizeof(Record));
+                callback(record.operation, record.key, record.value);
+            }
+            count_records += header.count_records;
+            valid_bytes += sizeof(BatchHeader) + batch.size();
+        }
+
+        return {count_records, valid_bytes};
+    }
+
+    void begin_batch() {
+        _buffer.resize(sizeof(BatchHeader));
+        _count_pending_records = 0U;
+    }
+
+    /**
+     * FNV-1a over the records of a batch.
+     */
+    [[nodiscard]] static std::uint64_t checksum(const char *data, const std::size_t size) noexcept {
+        auto hash = 14695981039346656037ULL;
+        for (auto i = 0ULL; i < size; ++i) {
+            hash = (hash ^ std::uint8_t(data[i])) * 1099511628211ULL;
+        }
+        return hash;
+    }
+};
@@ -0,0 +1,271 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <future>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "btree_olc.h"
+#include "coroutine/coroutine_async_executor.h"
+
+/**
+ * Shared-nothing front-end: The key space is partitioned into ranges, each owned by one tree and one
+ * worker (a CoroutineAsyncExecutor pinned to its own core). Requests are routed by key to the queue of
+ * the owning worker, so that no two workers ever touch the same node. Under skew, rebalance() moves the
+ * shard boundaries (and the entries between them) so that every shard receives a similar share of requests.
+ *
+ * Scans do not cross shard boundaries: A scan reads at most the entries of the shard owning its first key.
+ *
+ * @tparam Key Type of the keys.
+ * @tparam Value Type of the values.
+ * @tparam PageSize Size of a node.
+ * @tparam LeafLayout Layout of the leaves.
+ */
+template<class Key, class Value, std::size_t PageSize = 256U,
+        template<class, class, std::size_t> class LeafLayout = BTreeLeaf>
+class ShardedTree {
+public:
+    using Tree = BTree<Key, Value, PageSize, LeafLayout>;
+    using Executor = CoroutineAsyncExecutor<Tree>;
+    using key_type = Key;
+    using value_type = Value;
+
+    /**
+     * Creates the shards and starts their workers; shard i is pinned to core i (modulo the number of cores).
+     *
+     * @param count_shards Number of shards (and workers).
+     * @param max_key Keys are expected in [0, max_key); the initial boundaries split this range evenly.
+     * @param parallel_coroutines Number of requests interleaved at most by every worker
+     *  (default: the machine profile's depth).
+     */
+    ShardedTree(const std::uint16_t count_shards, const Key max_key,
+                const std::uint16_t parallel_coroutines = MachineProfile::current().parallel_coroutines)
+            : _parallel_coroutines(parallel_coroutines) {
+        assert(count_shards > 0U);
+        for (auto shard_id = 0U; shard_id < count_shards; ++shard_id) {
+            _shards.emplace_back(std::make_unique<Shard>());
+            if (shard_id > 0U) {
+                _boundaries.emplace_back(Key(max_key / count_shards * shard_id));
+            }
+        }
+        start();
+    }
+
+    ShardedTree(const ShardedTree &) = delete;
+
+    ShardedTree &operator=(const ShardedTree &) = delete;
+
+    /**
+     * Completes all submitted requests and stops the workers.
+     */
+    ~ShardedTree() = default;
+
+    /**
+     * Submits the request to the worker owning its key; thread-safe.
+     *
+     * @param request Request.
+     * @return Future holding the result; for lookups the found value (default-constructed if the key is missing).
+     */
+    std::future<Value> submit(const NumericTuple &request) {
+        return route(request).executor->submit(request);
+    }
+
+    /**
+     * Submits the request to the worker owning its key; thread-safe.
+     *
+     * @param request Request.
+     * @param callback Callback invoked on the worker thread once the request completed.
+     */
+    void submit(const NumericTuple &request, typename Executor::Callback &&callback) {
+        route(request).executor->submit(request, std::move(callback));
+    }
+
+    /**
+     * @return Index of the shard owning the key.
+     */
+    [[nodiscard]] std::uint16_t shard_of(const Key key) const noexcept {
+        return std::uint16_t(std::upper_bound(_boundaries.begin(), _boundaries.end(), key) - _boundaries.begin());
+    }
+
+    [[nodiscard]] std::uint16_t count_shards() const noexcept { return std::uint16_t(_shards.size()); }
+
+    /**
+     * @return Smallest key of every shard but the first one.
+     */
+    [[nodiscard]] const std::vector<Key> &boundaries() const noexcept { return _boundaries; }
+
+    /**
+     * @return Number of requests routed to the shard since it was created or last rebalanced.
+     */
+    [[nodiscard]] std::uint64_t count_requests(const std::uint16_t shard_id) const noexcept {
+        return _shards[shard_id]->count_requests.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @return The tree of the shard; must not be accessed while requests are submitted.
+     */
+    [[nodiscard]] Tree &tree(const std::uint16_t shard_id) noexcept { return _shards[shard_id]->tree; }
+
+    /**
+     * Moves the boundaries if the busiest shard received more than max_imbalance times the mean number of
+     * requests: New boundaries are the quantiles of the sampled request keys, and entries are moved to
+     * their new shards. Workers are stopped meanwhile; the caller must not submit requests concurrently.
+     *
+     * @param max_imbalance Ratio between the requests of the busiest shard and the mean tolerated.
+     * @return True, if the boundaries were moved.
+     */
+    bool rebalance(const double max_imbalance = 1.25) {
+        auto count_requests = std::uint64_t{0U};
+        auto max_requests = std::uint64_t{0U};
+        for (const auto &shard: _shards) {
+            count_requests += shard->count_requests.load();
+            max_requests = std::max(max_requests, shard->count_requests.load());
+        }
+        if (count_requests == 0U || _shards.size() == 1U ||
+            double(max_requests) <= max_imbalance * double(count_requests) / double(_shards.size())) {
+            return false;
+        }
+
+        stop();
+        _boundaries = balanced_boundaries(count_requests);
+        migrate();
+
+        reset_count_requests();
+        start();
+        return true;
+    }
+
+    /**
+     * Restarts counting (and sampling) the requests of every shard, e.g., when the workload changes.
+     */
+    void reset_count_requests() {
+        for (auto &shard: _shards) {
+            shard->count_requests.store(0U);
+        }
+    }
+
+private:
+    /// Every sample_rate-th request of a shard is sampled (to find balanced boundaries).
+    static constexpr std::uint64_t sample_rate = 64U;
+    static constexpr std::uint64_t count_samples = 1024U;
+
+    struct alignas(64) Shard {
+        Tree tree;
+        std::unique_ptr<Executor> executor;
+
+        alignas(64) std::atomic<std::uint64_t> count_requests{0U};
+
+        /// Ring of sampled keys, overwritten once full.
+        std::array<std::atomic<Key>, count_samples> samples{};
+    };
+
+    const std::uint16_t _parallel_coroutines;
+
+    std::vector<std::unique_ptr<Shard>> _shards;
+
+    /// Smallest key of shard i + 1.
+    std::vector<Key> _boundaries;
+
+    Shard &route(const NumericTuple &request) {
+        auto &shard = *_shards[shard_of(Key(request.key()))];
+        const auto index = shard.count_requests.fetch_add(1U, std::memory_order_relaxed);
+        if (index % sample_rate == 0U) {
+            shard.samples[(index / sample_rate) % count_samples].store(Key(request.key()), std::memory_order_relaxed);
+        }
+        return shard;
+    }
+
+    void start() {
+        const auto count_cores = std::max(1U, std::thread::hardware_concurrency());
+        for (auto shard_id = 0U; shard_id < _shards.size(); ++shard_id) {
+            _shards[shard_id]->executor = std::make_unique<Executor>(_shards[shard_id]->tree, _parallel_coroutines,
+                                                                     std::int32_t(shard_id % count_cores));
+        }
+    }
+
+    /**
+     * Completes the submitted requests and joins the workers.
+     */
+    void stop() {
+        for (auto &shard: _shards) {
+            shard->executor.reset();
+        }
+    }
+
+    /**
+     * @return Boundaries that split the sampled keys into shares of equal load. Samples of a shard stand for
+     *  as many requests as the shard received per sample, since the ring of a busy shard overflows.
+     */
+    std::vector<Key> balanced_boundaries(const std::uint64_t count_requests) const {
+        auto samples = std::vector<std::pair<Key, double>>{};
+        for (const auto &shard: _shards) {
+            const auto count_shard_requests = shard->count_requests.load();
+            const auto count_shard_samples = std::min(count_samples, (count_shard_requests + sample_rate - 1U) / sample_rate);
+            for (auto i = 0ULL; i < count_shard_samples; ++i) {
+                samples.emplace_back(shard->samples[i].load(),
+                                     double(count_shard_requests) / double(count_shard_samples));
+            }
+        }
+        std::sort(samples.begin(), samples.end());
+
+        auto boundaries = std::vector<Key>{};
+        const auto share = double(count_requests) / double(_shards.size());
+        auto load = 0.;
+        for (const auto &[key, weight]: samples) {
+            /// A key is never split: Shards of a single hot key are as balanced as it gets.
+            if (load >= share * double(boundaries.size() + 1U) && boundaries.size() + 1U < _shards.size() &&
+                (boundaries.empty() || boundaries.back() < key)) {
+                boundaries.emplace_back(key);
+            }
+            load += weight;
+        }
+
+        /// Fewer distinct keys than shards: The remaining shards own the keys above the largest sample.
+        while (boundaries.size() + 1U < _shards.size()) {
+            const auto last = boundaries.empty() ? samples.back().first : boundaries.back();
+            boundaries.emplace_back(last < std::numeric_limits<Key>::max() ? Key(last + 1U) : last);
+        }
+        return boundaries;
+    }
+
+    /**
+     * Moves every entry outside the new range of its shard to its new shard; the workers are stopped.
+     * Old ranges are ordered, so the entries moved to one shard are collected in key order.
+     */
+    void migrate() {
+        auto moved_entries = std::vector<std::vector<std::pair<Key, Value>>>(_shards.size());
+        for (auto shard_id = 0U; shard_id < _shards.size(); ++shard_id) {
+            auto &tree = _shards[shard_id]->tree;
+            auto moved_keys = std::vector<Key>{};
+            tree.for_each([&](const Key key, const Value &value) {
+                const auto target = shard_of(key);
+                if (target != shard_id) {
+                    moved_keys.emplace_back(key);
+                    moved_entries[target].emplace_back(key, value);
+                }
+            });
+
+            for (const auto key: moved_keys) {
+                complete(tree.remove(key));
+            }
+        }
+
+        for (auto shard_id = 0U; shard_id < _shards.size(); ++shard_id) {
+            const auto &entries = moved_entries[shard_id];
+            complete(_shards[shard_id]->tree.insert_batch(entries.data(), entries.data() + entries.size()));
+        }
+    }
+
+    static void complete(Coroutine &&coroutine) {
+        while (coroutine.is_done() == false) {
+            coroutine.resume();
+        }
+        coroutine.destroy();
+    }
+};
@@ -23,6 +23,44 @@ std::uint32_t System::cpu_max_mhz() {
     return 0;
 }
 
+std::vector<std::uint64_t> System::data_cache_sizes() {
+    auto sizes = std::vector<std::uint64_t>{};
+    for (auto index = 0U;; ++index) {
+        const auto path = std::string{"/sys/devices/system/cpu/cpu0/cache/index"}.append(std::to_string(index));
+        auto level_file = std::ifstream{path + "/level"};
+        auto type_file = std::ifstream{path + "/type"};
+        auto size_file = std::ifstream{path + "/size"};
+        if (level_file.is_open() == false || type_file.is_open() == false || size_file.is_open() == false) {
+            break;
+        }
+
+        auto level = 0U;
+        auto type = std::string{};
+        auto size = std::uint64_t{0U};
+        auto unit = char{'\0'};
+        level_file >> level;
+        type_file >> type;
+        size_file >> size >> unit;
+        if (type == "Instruction" || level == 0U) {
+            continue;
+        }
+
+        if (unit == 'K') {
+            size <<= 10U;
+        } else if (unit == 'M') {
+            size <<= 20U;
+        } else if (unit == 'G') {
+            size <<= 30U;
+        }
+        if (sizes.size() < level) {
+            sizes.resize(level, 0U);
+        }
+        sizes[level - 1U] = size;
+    }
+
+    return sizes;
+}
+
 std::string System::cpu_model_name() {
     auto cpu_info = std::ifstream{"/proc/cpuinfo"};
     std::string line;
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 class System {
 public:
@@ -9,5 +10,11 @@ public:
 
     [[nodiscard]] static std::uint32_t cpu_max_mhz();
 
+    /**
+     * @return Size (in bytes) of the data (or unified) cache of every level of the first core, L1 first;
+     *  empty if not reported.
+     */
+    [[nodiscard]] static std::vector<std::uint64_t> data_cache_sizes();
+
     [[nodiscard]] static std::string create_identifier_from_cpu_model_and_hostname();
 };
\ No newline at end of file
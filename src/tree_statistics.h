@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * Nodes and entries of one tree level.
+ */
+struct LevelFill {
+    /// Distance to the leaves (0 for leaves).
+    std::uint8_t height{0U};
+
+    std::uint64_t count_nodes{0U};
+
+    /// Keys in leaves, children in inner nodes.
+    std::uint64_t count_entries{0U};
+
+    /// Maximal number of entries per node; compressed leaves hold fewer the wider their key deltas.
+    std::uint64_t capacity{0U};
+
+    /// Entries all scanned nodes hold at most, by the capacity of each node.
+    std::uint64_t total_capacity{0U};
+
+    /// Fill of the emptiest node.
+    double lowest_fill{0.};
+
+    [[nodiscard]] double average_fill() const noexcept {
+        return total_capacity > 0U ? double(count_entries) / double(total_capacity) : 0.;
+    }
+
+    [[nodiscard]] double min_fill() const noexcept { return lowest_fill; }
+};
+
+/**
+ * Memory footprint and fill of a tree, see BTree::statistics().
+ */
+struct TreeStatistics {
+    /// All levels, the root first.
+    std::vector<LevelFill> levels;
+
+    /// Size of a node.
+    std::uint64_t page_size{0U};
+
+    /// False, if only the counters maintained by splits were read; entries and fill are not known then.
+    bool is_scanned{false};
+
+    /// Bytes of node memory handed out (including a mapped snapshot).
+    std::uint64_t allocated_bytes{0U};
+
+    /// Bytes of node memory mapped, including the unused tail of the last chunk.
+    std::uint64_t mapped_bytes{0U};
+
+    /// Bytes of values stored out-of-line (value heap).
+    std::uint64_t value_bytes{0U};
+
+    [[nodiscard]] std::uint64_t height() const noexcept { return levels.size(); }
+
+    [[nodiscard]] std::uint64_t count_nodes() const noexcept {
+        auto count = 0ULL;
+        for (const auto &level: levels) {
+            count += level.count_nodes;
+        }
+        return count;
+    }
+
+    /**
+     * @return Number of keys in the tree, or 0 if the nodes were not scanned.
+     */
+    [[nodiscard]] std::uint64_t count_entries() const noexcept {
+        return levels.empty() ? 0U : levels.back().count_entries;
+    }
+
+    /**
+     * @return Bytes of node memory holding entries (node pages weighted by their fill), or 0 if the nodes were not scanned.
+     */
+    [[nodiscard]] std::uint64_t used_bytes() const noexcept {
+        auto bytes = 0.;
+        for (const auto &level: levels) {
+            bytes += level.average_fill() * double(level.count_nodes * page_size);
+        }
+        return std::uint64_t(bytes);
+    }
+
+    [[nodiscard]] std::string to_string() const {
+        auto stream = std::stringstream{};
+        stream << std::fixed << std::setprecision(2) << "height: " << height() << ", nodes: " << count_nodes()
+               << ", allocated: " << mib(allocated_bytes) << " MiB, mapped: " << mib(mapped_bytes) << " MiB";
+        if (is_scanned) {
+            stream << ", used: " << mib(used_bytes()) << " MiB";
+        }
+        if (value_bytes > 0U) {
+            stream << ", values: " << mib(value_bytes) << " MiB";
+        }
+        stream << "\n" << std::setw(8) << "level" << std::setw(12) << "nodes" << std::setw(14) << "entries"
+               << std::setw(10) << "capacity" << std::setw(10) << "avg-fill" << std::setw(10) << "min-fill" << "\n";
+        for (auto level = 0U; level < levels.size(); ++level) {
+            const auto &fill = levels[level];
+            stream << std::setw(8) << name(level) << std::setw(12) << fill.count_nodes << std::setw(14);
+            if (is_scanned) {
+                stream << fill.count_entries << std::setw(10) << fill.capacity << std::setw(10) << fill.average_fill()
+                       << std::setw(10) << fill.min_fill() << "\n";
+            } else {
+                stream << "-" << std::setw(10) << fill.capacity << std::setw(10) << "-" << std::setw(10) << "-" << "\n";
+            }
+        }
+        return stream.str();
+    }
+
+    [[nodiscard]] std::string to_json() const {
+        auto stream = std::stringstream{};
+        stream << "{ \"height\": " << height() << ", \"nodes\": " << count_nodes() << ", \"allocated-bytes\": "
+               << allocated_bytes << ", \"mapped-bytes\": " << mapped_bytes << ", \"value-bytes\": " << value_bytes;
+        if (is_scanned) {
+            stream << ", \"entries\": " << count_entries() << ", \"used-bytes\": " << used_bytes();
+        }
+        stream << ", \"levels\": [";
+        for (auto level = 0U; level < levels.size(); ++level) {
+            const auto &fill = levels[level];
+            stream << (level > 0U ? ", " : "") << "{ \"level\": \"" << name(level) << "\", \"nodes\": "
+                   << fill.count_nodes << ", \"capacity\": " << fill.capacity;
+            if (is_scanned) {
+                stream << ", \"entries\": " << fill.count_entries << ", \"average-fill\": " << fill.average_fill()
+                       << ", \"min-fill\": " << fill.min_fill();
+            }
+            stream << "}";
+        }
+        stream << "]}";
+        return stream.str();
+    }
+
+private:
+    [[nodiscard]] std::string name(const std::uint32_t level) const {
+        return level + 1U == levels.size() ? std::string{"leaf"}
+                                           : std::string{"lvl-"}.append(std::to_string(level));
+    }
+
+    [[nodiscard]] static double mib(const std::uint64_t bytes) noexcept { return double(bytes) / double(1ULL << 20U); }
+};
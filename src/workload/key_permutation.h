@@ -0,0 +1,72 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+/**
+ * Pseudo-random permutation of [0, n), determined by the seed. The i-th element is computed from i alone
+ * (a Feistel network over the next power of two, walking the cycle until the result falls into [0, n)),
+ * so that any chunk of a shuffled sequence is generated independently, e.g., by one thread per chunk.
+ */
+class KeyPermutation {
+public:
+    /**
+     * @param n Number of elements.
+     * @param seed Seed; equal seeds yield equal permutations.
+     */
+    KeyPermutation(const std::uint64_t n, const std::uint64_t seed) : _n(n) {
+        /// Both halves have the same number of bits: The domain is below 4n.
+        _half_bits = std::max<std::uint32_t>(1U, (std::uint32_t(std::bit_width(n > 0U ? n - 1U : 0U)) + 1U) / 2U);
+        _half_mask = (std::uint64_t{1U} << _half_bits) - 1U;
+
+        auto state = seed;
+        for (auto &round_key: _round_keys) {
+            state += 0x9E3779B97F4A7C15ULL;
+            round_key = mix(state);
+        }
+    }
+
+    ~KeyPermutation() = default;
+
+    /**
+     * @param index Index in [0, n).
+     * @return The element at the index.
+     */
+    [[nodiscard]] std::uint64_t operator()(const std::uint64_t index) const noexcept {
+        auto value = encrypt(index);
+        while (value >= _n) {
+            value = encrypt(value);
+        }
+        return value;
+    }
+
+    [[nodiscard]] std::uint64_t size() const noexcept { return _n; }
+
+private:
+    const std::uint64_t _n;
+    std::uint32_t _half_bits;
+    std::uint64_t _half_mask;
+    std::array<std::uint64_t, 4U> _round_keys;
+
+    [[nodiscard]] std::uint64_t encrypt(const std::uint64_t value) const noexcept {
+        auto left = value >> _half_bits;
+        auto right = value & _half_mask;
+        for (const auto round_key: _round_keys) {
+            const auto next_right = left ^ (mix(right ^ round_key) & _half_mask);
+            left = right;
+            right = next_right;
+        }
+        return (left << _half_bits) | right;
+    }
+
+    /**
+     * @return Hash of the value (splitmix64 finalizer).
+     */
+    [[nodiscard]] static std::uint64_t mix(std::uint64_t value) noexcept {
+        value = (value ^ (value >> 30U)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27U)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31U);
+    }
+};
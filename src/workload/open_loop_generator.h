@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+#include "coroutine/coroutine_async_executor.h"
+#include "workload_set.h"
+
+/**
+ * Distribution of the time between two requests.
+ */
+enum class ArrivalProcess : std::uint8_t {
+    Constant = 0U,
+    Poisson = 1U
+};
+
+/**
+ * Latencies (from the scheduled arrival to the completion) of one open-loop run.
+ */
+struct OpenLoopResult {
+    /// Requests per second the generator was configured to issue.
+    double offered_rate;
+
+    /// Requests per second that completed (from the first scheduled arrival to the last completion).
+    double achieved_rate;
+
+    std::uint64_t count_requests;
+
+    std::chrono::nanoseconds p50;
+    std::chrono::nanoseconds p99;
+    std::chrono::nanoseconds p999;
+    std::chrono::nanoseconds max;
+
+    /**
+     * @param tolerance Fraction of the offered rate that has to be achieved.
+     * @return True, if the executor could not keep up with the offered rate.
+     */
+    [[nodiscard]] bool is_saturated(const double tolerance = .95) const noexcept {
+        return achieved_rate < offered_rate * tolerance;
+    }
+};
+
+/**
+ * Issues requests into an asynchronous executor at scheduled times, independent of completions (open loop).
+ * Latencies are measured from the scheduled arrival, so that time a request spends waiting for
+ * the generator or in the queue is included (no coordinated omission).
+ */
+class OpenLoopGenerator {
+public:
+    /**
+     * @param arrival_process Distribution of the time between requests.
+     * @param seed Seed of the (Poisson) arrival times.
+     */
+    explicit OpenLoopGenerator(const ArrivalProcess arrival_process, const std::uint64_t seed = 0U)
+            : _arrival_process(arrival_process), _seed(seed) {}
+
+    ~OpenLoopGenerator() = default;
+
+    /**
+     * Issues requests with the given rate until all are completed.
+     *
+     * @param executor Executor the requests are submitted to.
+     * @param requests Requests; used round-robin if count_requests exceeds their number.
+     * @param rate Requests per second.
+     * @param count_requests Number of requests to issue.
+     * @return Latencies and throughput.
+     */
+    template<typename T>
+    OpenLoopResult run(CoroutineAsyncExecutor<T> &executor, const std::vector<NumericTuple> &requests,
+                       const double rate, const std::uint64_t count_requests) const {
+        using namespace std::chrono;
+
+        /// Arrival times, relative to the start.
+        auto arrivals = std::vector<nanoseconds>{};
+        arrivals.reserve(count_requests);
+        auto random = std::mt19937_64{_seed};
+        auto exponential = std::exponential_distribution<double>{rate};
+        auto time = 0.;
+        for (auto i = 0ULL; i < count_requests; ++i) {
+            time += _arrival_process == ArrivalProcess::Poisson ? exponential(random) : 1. / rate;
+            arrivals.emplace_back(duration_cast<nanoseconds>(duration<double>{time}));
+        }
+
+        auto latencies = std::vector<nanoseconds>(count_requests);
+        auto completions = Completions{};
+
+        /// Requests are reused round-robin: Issuing does not allocate, so the generator saturates long after the tree.
+        auto in_flight = std::vector<OpenLoopRequest<T>>(std::min(count_requests, max_in_flight));
+        for (auto &request: in_flight) {
+            request.latencies = latencies.data();
+            request.completions = &completions;
+        }
+
+        const auto start = steady_clock::now();
+        for (auto i = 0ULL; i < count_requests; ++i) {
+            const auto arrival = start + arrivals[i];
+
+            /// Wait for the scheduled arrival (sleep if it is far away); if the generator fell behind, issue immediately.
+            if (arrival - steady_clock::now() > microseconds{100U}) {
+                std::this_thread::sleep_until(arrival - microseconds{50U});
+            }
+            while (steady_clock::now() < arrival) {
+#ifdef __x86_64__
+                _mm_pause();
+#endif
+            }
+
+            /// Far behind: The request issued max_in_flight requests ago is still running. The latency of the
+            /// next request still counts from its scheduled arrival, i.e., includes waiting here.
+            auto &request = in_flight[i % in_flight.size()];
+            if (i >= in_flight.size()) {
+                request.wait();
+            }
+            request.tuple = requests[i % requests.size()];
+            request.index = i;
+            request.arrival = arrival;
+            executor.submit(request);
+        }
+
+        /// Requests complete on the worker; wait until all are completed.
+        while (completions.count.load(std::memory_order_acquire) < count_requests) {
+            std::this_thread::yield();
+        }
+        for (const auto &request: in_flight) {
+            request.wait();
+        }
+
+        const auto last_completion = completions.last;
+        const auto seconds = duration<double>(last_completion - start).count();
+        std::sort(latencies.begin(), latencies.end());
+        const auto percentile = [&latencies](const double p) {
+            return latencies[std::min<std::uint64_t>(latencies.size() - 1U, std::uint64_t(double(latencies.size()) * p))];
+        };
+
+        return OpenLoopResult{rate, double(count_requests) / seconds, count_requests,
+                              percentile(.5), percentile(.99), percentile(.999), latencies.back()};
+    }
+
+    [[nodiscard]] static std::string to_string(const ArrivalProcess arrival_process) {
+        return arrival_process == ArrivalProcess::Poisson ? "poisson" : "constant";
+    }
+
+private:
+    /// Requests issued but not completed at most; the generator waits for the oldest beyond.
+    static constexpr std::uint64_t max_in_flight = 1ULL << 16U;
+
+    /**
+     * Completions of one run; written by the worker.
+     */
+    struct Completions {
+        std::atomic<std::uint64_t> count{0U};
+        std::chrono::steady_clock::time_point last;
+    };
+
+    /**
+     * Request that records its latency (from the scheduled arrival) when completed.
+     */
+    template<typename T>
+    struct OpenLoopRequest final : public CoroutineAsyncExecutor<T>::Request {
+        std::uint64_t index{0U};
+        std::chrono::steady_clock::time_point arrival;
+        std::chrono::nanoseconds *latencies{nullptr};
+        Completions *completions{nullptr};
+
+        void complete() override {
+            const auto now = std::chrono::steady_clock::now();
+            latencies[index] = std::chrono::duration_cast<std::chrono::nanoseconds>(now - arrival);
+            completions->last = now;
+            completions->count.fetch_add(1U, std::memory_order_release);
+            CoroutineAsyncExecutor<T>::Request::complete();
+        }
+    };
+
+    const ArrivalProcess _arrival_process;
+    const std::uint64_t _seed;
+};
@@ -1,11 +1,14 @@
 #include "workload_set.h"
+#include "key_permutation.h"
 #include <algorithm>
+#include <array>
 #include <fstream>
 #include <iostream>
 #include <mutex>
 #include <random>
 #include <thread>
 #include <numeric>
+#include <vector>
 
 NumericWorkloadSet::NumericWorkloadSet(const std::string &insert_workload_file,
                                        const std::string &mixed_workload_file) {
@@ -50,33 +53,51 @@ NumericWorkloadSet::NumericWorkloadSet(const std::string &insert_workload_file,
     mixed_thread.join();
 }
 
-NumericWorkloadSet::NumericWorkloadSet(const std::uint64_t count_insert, const std::uint64_t count_lookup) {
-    auto generate = [](const NumericTuple::Type type, const std::uint64_t max, std::vector<NumericTuple> &data_set) {
-        std::srand(std::uintptr_t(data_set.data()));
-
-        /// Fill data.
-        data_set.reserve(max);
-        for (auto i = 0ULL; i < max; ++i) {
-            data_set.emplace_back(type, i, i);
-        }
-
-        /// Shuffle.
-        std::random_device random_device;
-        auto random_engine = std::default_random_engine{random_device()};
-        std::shuffle(data_set.begin(), data_set.end(), random_engine);
-    };
+NumericWorkloadSet::NumericWorkloadSet(const std::uint64_t count_insert, const std::uint64_t count_lookup,
+                                       const std::uint64_t seed) {
+    const auto counts = std::array<std::uint64_t, 2U>{count_insert, count_lookup};
+    for (const auto phase: {phase::INSERT, phase::MIXED}) {
+        this->_data_sets[static_cast<std::size_t>(phase)].resize(counts[static_cast<std::size_t>(phase)],
+                                                                 NumericTuple{NumericTuple::Type::LOOKUP, 0U});
+    }
 
+    /// Every thread generates one chunk of each phase.
+    const auto count_threads = std::max(1U, std::thread::hardware_concurrency());
+    auto threads = std::vector<std::thread>{};
+    for (auto thread_id = 0U; thread_id < count_threads; ++thread_id) {
+        threads.emplace_back([this, &counts, seed, thread_id, count_threads]() {
+            for (const auto phase: {phase::INSERT, phase::MIXED}) {
+                const auto count = counts[static_cast<std::size_t>(phase)];
+                const auto begin = count * thread_id / count_threads;
+                const auto end = count * (thread_id + 1U) / count_threads;
+                generate(phase, count, seed, begin, end,
+                         this->_data_sets[static_cast<std::size_t>(phase)].data() + begin);
+            }
+        });
+    }
 
-    auto fill_thread = std::thread{[this, &generate, count_insert]() {
-        generate(NumericTuple::Type::INSERT, count_insert, this->_data_sets[static_cast<std::size_t>(phase::INSERT)]);
-    }};
+    for (auto &thread: threads) {
+        thread.join();
+    }
+}
 
-    auto mixed_thread = std::thread{[this, &generate, count_lookup]() {
-        generate(NumericTuple::Type::LOOKUP, count_lookup, this->_data_sets[static_cast<std::size_t>(phase::MIXED)]);
-    }};
+std::vector<NumericTuple> NumericWorkloadSet::generate(const phase phase, const std::uint64_t count,
+                                                       const std::uint64_t seed, const std::uint64_t begin,
+                                                       const std::uint64_t end) {
+    auto requests = std::vector<NumericTuple>(end - begin, NumericTuple{NumericTuple::Type::LOOKUP, 0U});
+    generate(phase, count, seed, begin, end, requests.data());
+    return requests;
+}
 
-    fill_thread.join();
-    mixed_thread.join();
+void NumericWorkloadSet::generate(const phase phase, const std::uint64_t count, const std::uint64_t seed,
+                                  const std::uint64_t begin, const std::uint64_t end, NumericTuple *requests) {
+    /// Both phases are shuffled differently.
+    const auto permutation = KeyPermutation{count, seed + static_cast<std::uint64_t>(phase)};
+    const auto type = phase == phase::INSERT ? NumericTuple::Type::INSERT : NumericTuple::Type::LOOKUP;
+    for (auto index = begin; index < end; ++index) {
+        const auto key = permutation(index);
+        requests[index - begin] = NumericTuple{type, key, std::int64_t(key)};
+    }
 }
 
 namespace benchmark {
@@ -13,7 +13,19 @@ public:
         INSERT,
         LOOKUP,
         UPDATE,
-        DELETE
+        DELETE,
+
+        /// Reads the given number (value) of entries starting at the key.
+        SCAN,
+
+        /// Adds the value to the value of the key (inserted with the value if missing).
+        ADD,
+
+        /// Sets the value of the key to desired() if the key exists and its value is expected().
+        COMPARE_AND_SET,
+
+        /// Inserts the key with the value unless it exists.
+        INSERT_IF_ABSENT
     };
 
     constexpr NumericTuple(const Type type, const std::uint64_t key) : _type(type), _key(key) {}
@@ -22,6 +34,16 @@ public:
             : _type(type), _key(key), _value(value) {
     }
 
+    /**
+     * Creates a COMPARE_AND_SET of the key; both operands are packed into the value (32 bits each), so that
+     * the tuple keeps its size.
+     */
+    [[nodiscard]] static constexpr NumericTuple compare_and_set(const std::uint64_t key, const std::uint32_t expected,
+                                                                const std::uint32_t desired) {
+        return NumericTuple{Type::COMPARE_AND_SET, key,
+                            std::int64_t((std::uint64_t(expected) << 32U) | std::uint64_t(desired))};
+    }
+
     NumericTuple(NumericTuple &&) noexcept = default;
 
     NumericTuple(const NumericTuple &) = default;
@@ -36,6 +58,12 @@ public:
 
     [[nodiscard]] std::int64_t value() const { return _value; }
 
+    /// Value the key is compared to by COMPARE_AND_SET.
+    [[nodiscard]] std::uint32_t expected() const { return std::uint32_t(std::uint64_t(_value) >> 32U); }
+
+    /// Value COMPARE_AND_SET sets the key to.
+    [[nodiscard]] std::uint32_t desired() const { return std::uint32_t(_value); }
+
     bool operator==(const Type type) const { return _type == type; }
 
 private:
@@ -44,13 +72,22 @@ private:
     std::int64_t _value = 0;
 };
 
+static_assert(sizeof(NumericTuple) == 24U, "Requests are streamed from memory; keep them small.");
+
 class NumericWorkloadSet {
     friend std::ostream &operator<<(std::ostream &stream, const NumericWorkloadSet &workload_set);
 
 public:
+    /// Seed of generated workloads if none is given: Runs with equal seeds execute identical requests.
+    static constexpr std::uint64_t default_seed = 1337U;
+
     NumericWorkloadSet() = default;
 
-    NumericWorkloadSet(std::uint64_t count_insert, std::uint64_t count_lookup);
+    /**
+     * Generates inserts of the keys 0..count_insert-1 and lookups of the keys 0..count_lookup-1, each phase
+     * in a pseudo-random order determined by the seed. Chunks of both phases are generated in parallel.
+     */
+    NumericWorkloadSet(std::uint64_t count_insert, std::uint64_t count_lookup, std::uint64_t seed = default_seed);
 
     NumericWorkloadSet(const std::string &insert_workload_file, const std::string &mixed_workload_file);
 
@@ -71,6 +108,26 @@ public:
 
     explicit operator bool() const { return insert_requests().empty() == false || mixed_requests().empty() == false; }
 
+    /**
+     * Generates the requests [begin, end) of a phase of count requests, identical to the requests a workload set
+     * with the same seed holds at these positions; lets every worker produce its chunk on demand.
+     *
+     * @param phase Phase (inserts or lookups).
+     * @param count Number of requests of the whole phase.
+     * @param seed Seed of the workload set.
+     * @param begin Index of the first request.
+     * @param end Index behind the last request.
+     * @return The requests.
+     */
+    [[nodiscard]] static std::vector<NumericTuple> generate(phase phase, std::uint64_t count, std::uint64_t seed,
+                                                            std::uint64_t begin, std::uint64_t end);
+
 private:
     std::array<std::vector<NumericTuple>, 2> _data_sets;
+
+    /**
+     * Writes the requests [begin, end) of a phase to the given memory.
+     */
+    static void generate(phase phase, std::uint64_t count, std::uint64_t seed, std::uint64_t begin, std::uint64_t end,
+                         NumericTuple *requests);
 };
\ No newline at end of file
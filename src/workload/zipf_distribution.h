@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+
+/**
+ * Zipfian distribution over [0, n), rank 0 being the most frequent (J. Gray et al., "Quickly Generating
+ * Billion-Record Synthetic Databases", as used by YCSB). Construction computes zeta(n) in O(n);
+ * drawing a value is O(1).
+ */
+class ZipfDistribution {
+public:
+    /**
+     * @param n Number of values.
+     * @param theta Skew, in (0, 1); YCSB uses 0.99.
+     */
+    ZipfDistribution(const std::uint64_t n, const double theta = .99) : _n(n), _theta(theta) {
+        for (auto i = 1ULL; i <= n; ++i) {
+            _zeta_n += 1. / std::pow(double(i), theta);
+        }
+        const auto zeta_2 = 1. + 1. / std::pow(2., theta);
+        _alpha = 1. / (1. - theta);
+        _eta = (1. - std::pow(2. / double(n), 1. - theta)) / (1. - zeta_2 / _zeta_n);
+    }
+
+    ~ZipfDistribution() = default;
+
+    template<typename G>
+    std::uint64_t operator()(G &generator) {
+        const auto u = _uniform(generator);
+        const auto uz = u * _zeta_n;
+        if (uz < 1.) {
+            return 0U;
+        }
+        if (uz < 1. + std::pow(.5, _theta)) {
+            return 1U;
+        }
+        return std::min<std::uint64_t>(_n - 1U, std::uint64_t(double(_n) * std::pow(_eta * u - _eta + 1., _alpha)));
+    }
+
+private:
+    const std::uint64_t _n;
+    const double _theta;
+    double _zeta_n{0.};
+    double _alpha;
+    double _eta;
+    std::uniform_real_distribution<double> _uniform{0., 1.};
+};